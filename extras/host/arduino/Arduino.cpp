@@ -0,0 +1,358 @@
+/*****************************************************************
+File:          Arduino.cpp
+Author:        BESTMODULES
+Description:   Simulated clock, pins and serial ports for the host build
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include "Arduino.h"
+#include "SoftwareSerial.h"
+#include <stdio.h>
+
+#define HOST_PIN_COUNT 64
+#define HOST_IRQ_COUNT 2
+
+static uint64_t hostClock = 0;
+static uint32_t hostYieldStep = 10;
+static uint8_t pinLevel[HOST_PIN_COUNT];
+static void (*irqHandler[HOST_IRQ_COUNT])(void);
+static bool irqEnabled = true;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+HardwareSerial Serial3;
+HardwareSerial Serial4;
+SoftwareSerial *SoftwareSerial::_ports = NULL;
+
+/* Serial is the console unless a simulated device is attached to it */
+static struct ConsoleInit
+{
+  ConsoleInit() { Serial.setConsole(true); }
+} consoleInit;
+
+/*-------------------------------------  Time  -------------------------------------*/
+uint32_t millis()
+{
+  return (uint32_t)(hostClock / 1000);
+}
+
+uint32_t micros()
+{
+  return (uint32_t)hostClock;
+}
+
+void delay(unsigned long ms)
+{
+  hostClock += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  hostClock += us;
+}
+
+void yield()
+{
+  hostClock += hostYieldStep;
+}
+
+uint64_t hostMicros()
+{
+  return hostClock;
+}
+
+void hostAdvance(uint64_t us)
+{
+  hostClock += us;
+}
+
+void hostSetYieldStep(uint32_t us)
+{
+  hostYieldStep = us;
+}
+
+void hostReset()
+{
+  hostClock = 0;
+  hostYieldStep = 10;
+  memset(pinLevel, 0, sizeof(pinLevel));
+  memset(irqHandler, 0, sizeof(irqHandler));
+}
+
+/*-------------------------------------  Pins  -------------------------------------*/
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if (pin < HOST_PIN_COUNT)
+  {
+    pinLevel[pin] = val ? HIGH : LOW;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  return (pin < HOST_PIN_COUNT) ? pinLevel[pin] : LOW;
+}
+
+/* Same mapping as an Arduino Uno: pin 2 -> INT0, pin 3 -> INT1 */
+int digitalPinToInterrupt(uint8_t pin)
+{
+  if (pin == 2 || pin == 3)
+  {
+    return pin - 2;
+  }
+  return NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode)
+{
+  (void)mode; // Always CHANGE: the driver filters edges itself
+  if (interruptNum < HOST_IRQ_COUNT)
+  {
+    irqHandler[interruptNum] = userFunc;
+  }
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+  if (interruptNum < HOST_IRQ_COUNT)
+  {
+    irqHandler[interruptNum] = NULL;
+  }
+}
+
+void noInterrupts()
+{
+  irqEnabled = false;
+}
+
+void interrupts()
+{
+  irqEnabled = true;
+}
+
+/* Drive an input pin from the simulation, firing its interrupt on a change */
+void hostSetPin(uint8_t pin, uint8_t level)
+{
+  int irq;
+  if (pin >= HOST_PIN_COUNT || pinLevel[pin] == (level ? HIGH : LOW))
+  {
+    return;
+  }
+  pinLevel[pin] = level ? HIGH : LOW;
+  irq = digitalPinToInterrupt(pin);
+  if (irq >= 0 && irqHandler[irq] != NULL && irqEnabled)
+  {
+    irqHandler[irq]();
+  }
+}
+
+/*-------------------------------------  Print  -------------------------------------*/
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (n < size && write(buffer[n]))
+  {
+    n++;
+  }
+  return n;
+}
+
+size_t Print::write(const char *str)
+{
+  return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const char *str)
+{
+  return write(str);
+}
+
+size_t Print::print(long n, int base)
+{
+  char buf[40];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%ld", n);
+  return write(buf);
+}
+
+size_t Print::print(double n, int digits)
+{
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::println()
+{
+  return write("\r\n");
+}
+
+size_t Print::println(const char *str)
+{
+  return print(str) + println();
+}
+
+size_t Print::println(long n, int base)
+{
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits)
+{
+  return print(n, digits) + println();
+}
+
+/*-------------------------------------  Serial  -------------------------------------*/
+void HostSerialPort::begin(unsigned long baud)
+{
+  _baud = baud;
+}
+
+void HostSerialPort::end()
+{
+  _baud = 0;
+}
+
+int HostSerialPort::available()
+{
+  _availableCalls++;
+  pump();
+  return (int)_fifo.size();
+}
+
+int HostSerialPort::read()
+{
+  int data;
+  pump();
+  if (_fifo.empty())
+  {
+    return -1;
+  }
+  data = _fifo.front();
+  _fifo.pop_front();
+  return data;
+}
+
+int HostSerialPort::peek()
+{
+  pump();
+  return _fifo.empty() ? -1 : _fifo.front();
+}
+
+size_t HostSerialPort::write(uint8_t data)
+{
+  if (_device != NULL)
+  {
+    _device->receive(data);
+  }
+  else if (_console)
+  {
+    fputc(data, stdout);
+  }
+  return 1;
+}
+
+void HostSerialPort::attach(HostSerialDevice *device)
+{
+  _device = device;
+}
+
+/* Schedule a byte; it enters the RX FIFO once the clock reaches timeUs */
+void HostSerialPort::deliver(uint8_t data, uint64_t timeUs)
+{
+  Arrival arrival = {timeUs, data};
+  _inFlight.push_back(arrival);
+}
+
+void HostSerialPort::setConsole(bool isConsole)
+{
+  _console = isConsole;
+}
+
+void HostSerialPort::setRxBufferSize(size_t size)
+{
+  _rxBufferSize = size;
+}
+
+unsigned long HostSerialPort::getBaud()
+{
+  return _baud;
+}
+
+uint32_t HostSerialPort::getOverflowCount()
+{
+  return _overflowCount;
+}
+
+uint32_t HostSerialPort::getAvailableCalls()
+{
+  return _availableCalls;
+}
+
+void HostSerialPort::clear()
+{
+  _inFlight.clear();
+  _fifo.clear();
+  _overflowCount = 0;
+  _availableCalls = 0;
+}
+
+/* Move bytes that have arrived into the FIFO, dropping them when it is full */
+void HostSerialPort::pump()
+{
+  if (_device != NULL)
+  {
+    _device->service();
+  }
+  while (!_inFlight.empty() && _inFlight.front().timeUs <= hostClock)
+  {
+    if (_fifo.size() < _rxBufferSize)
+    {
+      _fifo.push_back(_inFlight.front().data);
+    }
+    else
+    {
+      _overflowCount++;
+    }
+    _inFlight.pop_front();
+  }
+}
+
+SoftwareSerial::SoftwareSerial(uint8_t rxPin, uint8_t txPin, bool inverseLogic)
+{
+  (void)txPin;
+  (void)inverseLogic;
+  _rxPin = rxPin;
+  _nextPort = _ports;
+  _ports = this;
+}
+
+SoftwareSerial::~SoftwareSerial()
+{
+  SoftwareSerial **link = &_ports;
+  while (*link != NULL && *link != this)
+  {
+    link = &(*link)->_nextPort;
+  }
+  if (*link == this)
+  {
+    *link = _nextPort;
+  }
+}
+
+/* Most recently created port on rxPin */
+SoftwareSerial *SoftwareSerial::find(uint8_t rxPin)
+{
+  SoftwareSerial *port = _ports;
+  while (port != NULL && port->_rxPin != rxPin)
+  {
+    port = port->_nextPort;
+  }
+  return port;
+}
@@ -0,0 +1,142 @@
+/*****************************************************************
+File:             Arduino.h
+Author:           BESTMODULES
+Description:      Minimal Arduino core for building the library on a
+                  Linux host. Time is simulated: it only advances in
+                  delay(), yield() and hostAdvance().
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <deque>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+uint32_t millis();
+uint32_t micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts();
+void interrupts();
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t data) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str);
+  size_t print(const char *str);
+  size_t print(long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+  size_t println();
+  size_t println(const char *str);
+  size_t println(long n, int base = DEC);
+  size_t println(double n, int digits = 2);
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+};
+
+/* Something on the other end of a simulated serial line */
+class HostSerialDevice
+{
+public:
+  virtual ~HostSerialDevice() {}
+  virtual void receive(uint8_t data) = 0; // Byte written by the host
+  virtual void service() = 0;             // Produce bytes due up to the current time
+};
+
+/* Serial port whose received bytes appear at simulated arrival times */
+class HostSerialPort : public Stream
+{
+public:
+  void begin(unsigned long baud);
+  void end();
+  int available();
+  int read();
+  int peek();
+  size_t write(uint8_t data);
+  using Print::write;
+  operator bool() { return true; }
+
+  void attach(HostSerialDevice *device);
+  void deliver(uint8_t data, uint64_t timeUs);
+  void setConsole(bool isConsole);
+  void setRxBufferSize(size_t size);
+  unsigned long getBaud();
+  uint32_t getOverflowCount();
+  uint32_t getAvailableCalls();
+  void clear();
+
+private:
+  struct Arrival
+  {
+    uint64_t timeUs;
+    uint8_t data;
+  };
+  unsigned long _baud = 0;
+  bool _console = false;
+  size_t _rxBufferSize = 64;
+  uint32_t _overflowCount = 0;
+  uint32_t _availableCalls = 0;
+  HostSerialDevice *_device = NULL;
+  std::deque<Arrival> _inFlight;
+  std::deque<uint8_t> _fifo;
+  void pump();
+};
+
+class HardwareSerial : public HostSerialPort
+{
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
+extern HardwareSerial Serial4;
+
+/* Host control, not part of the Arduino API */
+uint64_t hostMicros();
+void hostAdvance(uint64_t us);
+void hostSetYieldStep(uint32_t us);
+void hostSetPin(uint8_t pin, uint8_t level);
+void hostReset();
+
+#endif
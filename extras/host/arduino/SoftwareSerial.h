@@ -0,0 +1,30 @@
+/*****************************************************************
+File:             SoftwareSerial.h
+Author:           BESTMODULES
+Description:      SoftwareSerial for the host build, a simulated port
+                  found by its RX pin with SoftwareSerial::find()
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#ifndef _HOST_SOFTWARESERIAL_H_
+#define _HOST_SOFTWARESERIAL_H_
+
+#include "Arduino.h"
+
+class SoftwareSerial : public HostSerialPort
+{
+public:
+  SoftwareSerial(uint8_t rxPin, uint8_t txPin, bool inverseLogic = false);
+  ~SoftwareSerial();
+  bool listen() { return true; }
+  bool isListening() { return true; }
+  bool overflow() { return false; }
+  static SoftwareSerial *find(uint8_t rxPin);
+
+private:
+  uint8_t _rxPin;
+  SoftwareSerial *_nextPort;
+  static SoftwareSerial *_ports;
+};
+
+#endif
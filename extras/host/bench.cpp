@@ -0,0 +1,206 @@
+/*****************************************************************
+File:          bench.cpp
+Author:        BESTMODULES
+Description:   Benchmarks of the library against BM22S402x_1_Sim.
+               Prints one JSON object per line:
+               - framer: bytes/s and packets/s of the AUTO mode packet
+                 framer(host CPU time) at several noise rates, over
+                 HardwareSerial and the BM22S402x_1_SoftSerial transport
+               - command: round-trip latency of the blocking API
+                 (simulated time) and host CPU time per call
+               - blocking: worst-case time spent inside isStable()/isTrigger()
+Usage:         bench [--quick]
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "BM22S402x-1.h"
+#include "BM22S402x-1_Sim.h"
+
+#ifndef BM22S402x_1_VERSION
+#define BM22S402x_1_VERSION "unknown"
+#endif
+
+typedef std::chrono::steady_clock WallClock;
+
+static double secondsSince(WallClock::time_point start)
+{
+  return std::chrono::duration<double>(WallClock::now() - start).count();
+}
+
+/* Latency statistics in microseconds */
+struct Latency
+{
+  uint64_t min = UINT64_MAX;
+  uint64_t max = 0;
+  uint64_t sum = 0;
+  uint32_t count = 0;
+
+  void add(uint64_t us)
+  {
+    min = us < min ? us : min;
+    max = us > max ? us : max;
+    sum += us;
+    count++;
+  }
+};
+
+/* Stream `seconds` of AUTO mode output into the RX FIFO at once, then time the framer */
+static void benchFramer(const char *link, double noiseRate, uint32_t seconds)
+{
+  hostReset();
+  bool isSoft = strcmp(link, "soft_serial") == 0;
+  HardwareSerial hardPort;
+  BM22S402x_1_SoftSerial softLink(4, 5);
+  HostSerialPort &port = isSoft ? (HostSerialPort &)softLink.getSerial() : hardPort;
+  BM22S402x_1 hardPir(&hardPort), softPir(&softLink);
+  BM22S402x_1 &pir = isSoft ? softPir : hardPir;
+  BM22S402x_1_Sim sim(port, 12345);
+  BM22S402x_1_History<16> history;
+  uint32_t packets = 0;
+  uint64_t bytes;
+
+  port.setRxBufferSize((size_t)-1);
+  sim.setBaud(10000000); // 1 us per byte
+  sim.setPacketInterval(1);
+  sim.setWarmupTime(0);
+  sim.setMotionPattern(100, 30);
+  sim.setNoiseRate(noiseRate);
+  sim.setCorruptRate(noiseRate / 4);
+  hostAdvance((uint64_t)seconds * 1000000);
+  sim.service();
+  bytes = sim.bytesSent;
+  port.available(); // Move everything into the FIFO before timing
+  pir.attachHistory(&history);
+
+  WallClock::time_point start = WallClock::now();
+  while (port.available() > 0)
+  {
+    pir.update();
+  }
+  double elapsed = secondsSince(start);
+  packets = history.available() + history.getDropCount();
+
+  printf("{\"bench\":\"framer\",\"version\":\"%s\",\"link\":\"%s\",\"noise_rate\":%.3f,\"bytes\":%llu,"
+         "\"packets_sent\":%u,\"packets_received\":%u,\"bytes_per_sec\":%.0f,\"packets_per_sec\":%.0f}\n",
+         BM22S402x_1_VERSION, link, noiseRate, (unsigned long long)bytes, (unsigned)sim.packetsSent,
+         (unsigned)packets, bytes / elapsed, packets / elapsed);
+}
+
+static void printLatency(const char *name, const Latency &simTime, double cpuSeconds)
+{
+  printf("{\"bench\":\"command\",\"version\":\"%s\",\"call\":\"%s\",\"calls\":%u,"
+         "\"latency_us_min\":%llu,\"latency_us_mean\":%llu,\"latency_us_max\":%llu,\"cpu_ns_per_call\":%.0f}\n",
+         BM22S402x_1_VERSION, name, (unsigned)simTime.count, (unsigned long long)simTime.min,
+         (unsigned long long)(simTime.sum / simTime.count), (unsigned long long)simTime.max,
+         cpuSeconds * 1e9 / simTime.count);
+}
+
+/* Round-trip latency of each blocking call in simulated time */
+static void benchCommands(uint32_t calls)
+{
+  hostReset();
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 1);
+  const char *names[] = {"readCommand(0x04)", "writeCommand(0x07)", "readPIR", "readRawPIR", "readTemperature", "readAllRegisters"};
+  BM22S402x_1_Registers regs;
+  uint8_t n, i;
+
+  sim.setPacketInterval(100);
+  pir.begin();
+  for (n = 0; n < 6; n++)
+  {
+    Latency latency;
+    WallClock::time_point start = WallClock::now();
+    for (i = 0; i < calls; i++)
+    {
+      uint64_t t0 = hostMicros();
+      switch (n)
+      {
+      case 0:
+        pir.readCommand(0x04);
+        break;
+      case 1:
+        pir.invalidateCache(); // Measure the bus, not the cache
+        pir.writeCommand(0x07, i & 0x07);
+        break;
+      case 2:
+        pir.readPIR();
+        break;
+      case 3:
+        pir.readRawPIR();
+        break;
+      case 4:
+        pir.readTemperature();
+        break;
+      default:
+        pir.readAllRegisters(regs);
+        break;
+      }
+      latency.add(hostMicros() - t0);
+      hostAdvance(20000); // Idle gap between calls
+    }
+    printLatency(names[n], latency, secondsSince(start));
+  }
+}
+
+/* Longest time the sketch is stuck inside isStable()/isTrigger() */
+static void benchBlocking(const char *mode, uint16_t control, uint8_t statusPin, uint32_t calls)
+{
+  hostReset();
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 7);
+  Latency stable, trigger;
+  uint32_t i;
+
+  sim.setRegister(0x04, control);
+  sim.setWarmupTime(500);
+  sim.setMotionPattern(1000, 300);
+  if (statusPin != 0xff)
+  {
+    sim.setStatusPin(statusPin);
+    pir.begin(statusPin);
+  }
+  else
+  {
+    pir.begin();
+  }
+  for (i = 0; i < calls; i++)
+  {
+    uint64_t t0 = hostMicros();
+    pir.isStable();
+    stable.add(hostMicros() - t0);
+    t0 = hostMicros();
+    pir.isTrigger();
+    trigger.add(hostMicros() - t0);
+    hostAdvance(7000);
+  }
+  printf("{\"bench\":\"blocking\",\"version\":\"%s\",\"mode\":\"%s\",\"calls\":%u,"
+         "\"isStable_us_mean\":%llu,\"isStable_us_max\":%llu,\"isTrigger_us_mean\":%llu,\"isTrigger_us_max\":%llu}\n",
+         BM22S402x_1_VERSION, mode, (unsigned)calls,
+         (unsigned long long)(stable.sum / calls), (unsigned long long)stable.max,
+         (unsigned long long)(trigger.sum / calls), (unsigned long long)trigger.max);
+}
+
+int main(int argc, char *argv[])
+{
+  bool quick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+  const double noiseRates[] = {0.0, 0.01, 0.1, 0.5};
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    benchFramer("hardware", noiseRates[i], quick ? 2 : 20);
+  }
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    benchFramer("soft_serial", noiseRates[i], quick ? 2 : 20);
+  }
+  benchCommands(quick ? 20 : 200);
+  benchBlocking("auto", 0x6b, 0xff, quick ? 50 : 500);
+  benchBlocking("command", 0x6a, 0xff, quick ? 50 : 500);
+  benchBlocking("status_pin", 0x6b, 2, quick ? 50 : 500);
+  return 0;
+}
@@ -0,0 +1,313 @@
+/*****************************************************************
+File:          fuzz_framer.cpp
+Author:        BESTMODULES
+Description:   Property test of the frame receiver: arbitrary byte
+               streams are fed to the library through a scripted
+               transport and checked against a reference framer.
+                 fuzz_framer [cases]    random structured streams
+                 fuzz_framer file...    replay inputs, e.g. a crash
+               Built with clang, fuzz_framer_libfuzzer runs the same
+               check under libFuzzer.
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BM22S402x-1.h"
+
+/* Hands a byte stream to the library in chunks of a fixed size */
+class MockTransport : public BM22S402x_1_Transport
+{
+public:
+  const uint8_t *data = NULL;
+  size_t size = 0;
+  size_t pos = 0;
+  uint8_t chunk = 16;
+  size_t taken = 0; // Bytes read since the counter was cleared
+  uint32_t writes = 0;
+
+  void begin(uint32_t baud) { (void)baud; }
+  uint8_t read(uint8_t buf[], uint8_t len)
+  {
+    size_t n = size - pos;
+    n = n < len ? n : len;
+    n = n < chunk ? n : chunk;
+    memcpy(buf, data + pos, n);
+    pos += n;
+    taken += n;
+    return (uint8_t)n;
+  }
+  void write(const uint8_t buf[], uint8_t len)
+  {
+    (void)buf;
+    (void)len;
+    writes++;
+  }
+};
+
+struct Packet
+{
+  size_t pos;
+  uint8_t data[7];
+};
+
+static std::vector<BM22S402x_1_Sample> received;
+static void collect(const BM22S402x_1_Sample &sample) { received.push_back(sample); }
+
+static void require(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    fprintf(stderr, "FAIL: %s\n", what);
+    abort();
+  }
+}
+
+/* Longest reply data of each command code, from the module protocol; -1: not sent by the module */
+static int maxDataLen(uint8_t cmd)
+{
+  static const int8_t replyLen[17] = {-1, 2, 2, 10, 1, 1, 1, 1, 2, 2, 1, 1, 1, 0, -1, 0, 2};
+  if (cmd == 0x55)
+  {
+    return 7;
+  }
+  if (cmd == 0xab)
+  {
+    return 0;
+  }
+  return cmd < 17 ? replyLen[cmd] : -1;
+}
+
+/* Reference framer: the earliest valid frame wins, scanning resumes after it */
+static std::vector<Packet> referencePackets(const uint8_t *s, size_t n)
+{
+  std::vector<Packet> packets;
+  size_t i = 0, k;
+  while (i + 4 <= n)
+  {
+    int maxLen = (s[i] == 0xfb) ? maxDataLen(s[i + 1]) : -1;
+    size_t len = s[i + 2];
+    uint8_t sum = 0;
+    if (maxLen < 0 || (int)len > maxLen || i + len + 4 > n)
+    {
+      i++;
+      continue;
+    }
+    for (k = 1; k < len + 3; k++)
+    {
+      sum += s[i + k];
+    }
+    if (sum != s[i + len + 3])
+    {
+      i++;
+      continue;
+    }
+    if (s[i + 1] == 0x55 && len == 7)
+    {
+      Packet packet;
+      packet.pos = i;
+      memcpy(packet.data, s + i + 3, 7);
+      packets.push_back(packet);
+    }
+    i += len + 4;
+  }
+  return packets;
+}
+
+/* Feed one stream and check the properties */
+static void checkStream(const uint8_t *s, size_t n, uint8_t chunk, bool isCommand)
+{
+  hostReset();
+  MockTransport link;
+  BM22S402x_1 pir(&link);
+  std::vector<Packet> expected = referencePackets(s, n);
+  uint32_t updates = 0, end;
+  size_t i;
+
+  link.data = s;
+  link.size = n;
+  link.chunk = chunk;
+  received.clear();
+  pir.onPacket(collect);
+  pir.begin();
+  if (isCommand)
+  {
+    pir.submitCommand(0x04); // Its reply may be anywhere in the stream
+  }
+  while (link.pos < n)
+  {
+    link.taken = 0;
+    pir.update();
+    require(link.taken > 0, "every update() makes progress");
+    require(link.taken <= BM22S402x_1_MAX_BYTES_PER_UPDATE, "bytes per update() are bounded");
+    require(++updates <= n, "stream consumed in a bounded number of calls");
+    hostAdvance(100);
+  }
+  end = millis() + 2000;
+  while (pir.isBusy() && millis() < end)
+  {
+    pir.update();
+    hostAdvance(1000);
+  }
+  require(!pir.isBusy(), "command completes whatever the stream");
+
+  require(received.size() == expected.size(), "packets match the reference framer");
+  for (i = 0; i < expected.size(); i++)
+  {
+    const uint8_t *d = expected[i].data;
+    const BM22S402x_1_Sample &got = received[i];
+    require(got.rawPIR == (d[0] | d[1] << 8) && got.PIR == (d[2] | d[3] << 8) && got.status == d[4] &&
+                (uint16_t)got.temperature == (d[5] | d[6] << 8),
+            "packet contents match the reference framer");
+  }
+}
+
+/* Input: flags byte(bits 0~3: chunk size - 1, bit 4: command pending), then the stream */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  if (size > 0)
+  {
+    checkStream(data + 1, size - 1, (data[0] & 0x0f) + 1, (data[0] & 0x10) != 0);
+  }
+  return 0;
+}
+
+#ifndef BM22S402x_1_LIBFUZZER
+static uint32_t seed = 1;
+static uint32_t random32()
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+static void appendFrame(std::vector<uint8_t> &s, uint8_t cmd, uint8_t len)
+{
+  uint8_t sum = cmd + len, i, b;
+  s.push_back(0xfb);
+  s.push_back(cmd);
+  s.push_back(len);
+  for (i = 0; i < len; i++)
+  {
+    b = (random32() % 8 == 0) ? 0xfb : random32(); // Data may look like a frame start
+    s.push_back(b);
+    sum += b;
+  }
+  s.push_back(sum);
+}
+
+/* Packets, replies, error frames, broken frames and noise in random order */
+static void randomStream(std::vector<uint8_t> &s, std::vector<size_t> &inserted)
+{
+  static const uint8_t noise[] = {0xfb, 0x55, 0xab, 0x07, 0x00, 0x04};
+  uint8_t cmd, n;
+  size_t start;
+  s.clear();
+  inserted.clear();
+  while (s.size() < 300)
+  {
+    start = s.size();
+    switch (random32() % 6)
+    {
+    case 0:
+    case 1:
+      inserted.push_back(start);
+      appendFrame(s, 0x55, 7);
+      break;
+    case 2:
+      cmd = 1 + random32() % 16;
+      if (maxDataLen(cmd) >= 0)
+      {
+        appendFrame(s, cmd, random32() % (maxDataLen(cmd) + 1));
+      }
+      break;
+    case 3:
+      appendFrame(s, (random32() % 2) ? 0xab : 0x55, (random32() % 2) ? 0 : 7);
+      s.resize(start + 1 + random32() % (s.size() - start)); // Truncated
+      break;
+    case 4:
+      appendFrame(s, 0x55, 7);
+      s[start + 1 + random32() % 10] ^= 1 << (random32() % 8); // Corrupted
+      break;
+    default:
+      for (n = 1 + random32() % 8; n > 0; n--)
+      {
+        s.push_back((random32() % 2) ? noise[random32() % sizeof(noise)] : random32());
+      }
+      break;
+    }
+  }
+}
+
+/* A packet with no frame start in the 13 bytes before it cannot be overlapped by another frame */
+static void checkInserted(const std::vector<uint8_t> &s, const std::vector<size_t> &inserted)
+{
+  std::vector<Packet> found = referencePackets(s.data(), s.size());
+  size_t i, j, k = 0;
+  bool isClear;
+  for (i = 0; i < inserted.size(); i++)
+  {
+    isClear = true;
+    for (j = (inserted[i] > 13) ? inserted[i] - 13 : 0; j < inserted[i]; j++)
+    {
+      isClear = isClear && s[j] != 0xfb;
+    }
+    while (k < found.size() && found[k].pos < inserted[i])
+    {
+      k++;
+    }
+    require(!isClear || (k < found.size() && found[k].pos == inserted[i]), "no valid packet lost");
+  }
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> &data)
+{
+  FILE *file = fopen(path, "rb");
+  int c;
+  if (file == NULL)
+  {
+    return false;
+  }
+  data.clear();
+  while ((c = fgetc(file)) != EOF)
+  {
+    data.push_back((uint8_t)c);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  std::vector<uint8_t> stream;
+  std::vector<size_t> inserted;
+  uint32_t cases = 20000, i;
+  int arg;
+
+  if (argc > 1 && strspn(argv[1], "0123456789") != strlen(argv[1]))
+  {
+    for (arg = 1; arg < argc; arg++)
+    {
+      require(readFile(argv[arg], stream), "input file readable");
+      LLVMFuzzerTestOneInput(stream.data(), stream.size());
+      printf("ok  : %s\n", argv[arg]);
+    }
+    return 0;
+  }
+  if (argc > 1)
+  {
+    cases = strtoul(argv[1], NULL, 10);
+  }
+  for (i = 0; i < cases; i++)
+  {
+    randomStream(stream, inserted);
+    checkInserted(stream, inserted);
+    checkStream(stream.data(), stream.size(), 1 + random32() % 16, random32() % 4 == 0);
+  }
+  printf("ok  : %u random streams\n", (unsigned)cases);
+  return 0;
+}
+#endif
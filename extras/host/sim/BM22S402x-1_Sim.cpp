@@ -0,0 +1,382 @@
+/*****************************************************************
+File:          BM22S402x-1_Sim.cpp
+Author:        BESTMODULES
+Description:   Software model of a BM22S402x-1 module.
+               Frame: 0xFB, cmd, len, data[len], checksum(sum of cmd..data).
+               Control register bit0 selects AUTO output, bit3 enables PIR.
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include "BM22S402x-1_Sim.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+BM22S402x_1_Sim::BM22S402x_1_Sim(HostSerialPort &port, uint32_t seed) : _port(port)
+{
+  const uint8_t defaultID[10] = {0x42, 0x4d, 0x32, 0x32, 0x53, 0x34, 0x30, 0x32, 0x31, 0x01};
+  _seed = seed ? seed : 1;
+  memcpy(_devID, defaultID, 10);
+  packetsSent = repliesSent = commandsReceived = 0;
+  bytesSent = bytesDropped = framesCorrupted = noiseBytes = 0;
+  restoreRegisters();
+  _port.attach(this);
+  powerOn();
+}
+
+void BM22S402x_1_Sim::setPacketInterval(uint32_t ms)
+{
+  _packetInterval = ms;
+}
+
+void BM22S402x_1_Sim::setReplyDelay(uint32_t us)
+{
+  _replyDelay = us;
+}
+
+void BM22S402x_1_Sim::setBaud(uint32_t baud)
+{
+  _byteTime = (10000000UL + baud - 1) / baud;
+}
+
+void BM22S402x_1_Sim::setWarmupTime(uint32_t ms)
+{
+  _warmupTime = ms;
+}
+
+void BM22S402x_1_Sim::setStatusPin(uint8_t pin)
+{
+  _statusPin = pin;
+}
+
+void BM22S402x_1_Sim::setMotion(bool isActive)
+{
+  _motion = isActive;
+  _motionPeriod = 0;
+}
+
+/* Motion for activeMs at the start of every periodMs */
+void BM22S402x_1_Sim::setMotionPattern(uint32_t periodMs, uint32_t activeMs)
+{
+  _motionPeriod = periodMs;
+  _motionActive = activeMs;
+}
+
+/* Unit: 0.1 Centigrade */
+void BM22S402x_1_Sim::setTemperature(int16_t temperature)
+{
+  _temperature = temperature;
+}
+
+void BM22S402x_1_Sim::setDeviceID(const uint8_t devID[10])
+{
+  memcpy(_devID, devID, 10);
+}
+
+void BM22S402x_1_Sim::setRegister(uint8_t readCmd, uint16_t value)
+{
+  switch (readCmd)
+  {
+  case 0x04:
+    _control = value;
+    break;
+  case 0x06:
+    _sensitivity = value;
+    break;
+  case 0x08:
+    _delayTime = value;
+    break;
+  case 0x0a:
+    _blockTime = value;
+    break;
+  default:
+    break;
+  }
+}
+
+uint16_t BM22S402x_1_Sim::getRegister(uint8_t readCmd)
+{
+  switch (readCmd)
+  {
+  case 0x04:
+    return _control;
+  case 0x06:
+    return _sensitivity;
+  case 0x08:
+    return _delayTime;
+  case 0x0a:
+    return _blockTime;
+  case 0x0c:
+    return statusBits(hostMicros());
+  default:
+    return 0;
+  }
+}
+
+/* Restart warm-up and the AUTO mode packet schedule */
+void BM22S402x_1_Sim::powerOn()
+{
+  _powerOnAt = hostMicros();
+  _nextPacketAt = _powerOnAt + (uint64_t)_packetInterval * 1000;
+  _sleeping = false;
+  _busyUntil = 0;
+}
+
+void BM22S402x_1_Sim::setNoiseRate(double rate)
+{
+  _noiseRate = rate;
+}
+
+void BM22S402x_1_Sim::setDropRate(double rate)
+{
+  _dropRate = rate;
+}
+
+void BM22S402x_1_Sim::setCorruptRate(double rate)
+{
+  _corruptRate = rate;
+}
+
+void BM22S402x_1_Sim::setReplyLossRate(double rate)
+{
+  _replyLossRate = rate;
+}
+
+/* Byte written by the driver */
+void BM22S402x_1_Sim::receive(uint8_t data)
+{
+  uint64_t now = hostMicros();
+  generateUntil(now);
+  if (_sleeping)
+  {
+    _sleeping = false; // Any UART activity wakes the module
+    _nextPacketAt = now + (uint64_t)_packetInterval * 1000;
+  }
+  if (_rxLen == 0 && data != 0xfb)
+  {
+    return;
+  }
+  _rx[_rxLen++] = data;
+  if (_rxLen == 3 && _rx[2] > 2)
+  {
+    _rxLen = 0;
+    return;
+  }
+  if (_rxLen >= 4 && _rxLen == _rx[2] + 4)
+  {
+    commandsReceived++;
+    handleCommand(now + _replyDelay);
+    _rxLen = 0;
+  }
+}
+
+void BM22S402x_1_Sim::service()
+{
+  generateUntil(hostMicros());
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/* Emit AUTO mode packets and STATUS pin changes due up to timeUs */
+void BM22S402x_1_Sim::generateUntil(uint64_t timeUs)
+{
+  if (_statusPin != 0xff && timeUs <= hostMicros())
+  {
+    hostSetPin(_statusPin, (statusBits(timeUs) & 0x01) ? HIGH : LOW);
+  }
+  if (_packetInterval == 0)
+  {
+    return;
+  }
+  while (_nextPacketAt <= timeUs)
+  {
+    if ((_control & 0x01) && !_sleeping && _nextPacketAt >= _busyUntil)
+    {
+      sendPacket(_nextPacketAt);
+    }
+    _nextPacketAt += (uint64_t)_packetInterval * 1000;
+  }
+}
+
+void BM22S402x_1_Sim::sendPacket(uint64_t timeUs)
+{
+  uint8_t data[7];
+  uint16_t raw, filtered;
+  uint8_t status = statusBits(timeUs);
+  _phase++;
+  raw = 2048 + (int16_t)(random() % 41) - 20;
+  if (status & 0x01)
+  {
+    raw += (_phase & 0x08) ? 300 : -300;
+  }
+  filtered = 2048 + ((int16_t)raw - 2048) / 4;
+  data[0] = raw;
+  data[1] = raw >> 8;
+  data[2] = filtered;
+  data[3] = filtered >> 8;
+  data[4] = status;
+  data[5] = _temperature;
+  data[6] = (uint16_t)_temperature >> 8;
+  sendFrame(timeUs, 0x55, data, 7, false);
+  packetsSent++;
+}
+
+void BM22S402x_1_Sim::handleCommand(uint64_t timeUs)
+{
+  uint8_t cmd = _rx[1], len = _rx[2], i, checkSum = 0, data[2];
+  uint16_t value;
+  for (i = 1; i < len + 3; i++)
+  {
+    checkSum += _rx[i];
+  }
+  if (checkSum != _rx[len + 3] || timeUs < _busyUntil)
+  {
+    sendFrame(timeUs, 0xab, NULL, 0, true);
+    return;
+  }
+  if (len == 0)
+  {
+    switch (cmd)
+    {
+    case 0x01:
+    case 0x02:
+      data[0] = 0x00; // 2048: idle PIR level
+      data[1] = 0x08;
+      sendFrame(timeUs, cmd, data, 2, true);
+      return;
+    case 0x03:
+      sendFrame(timeUs, cmd, _devID, 10, true);
+      return;
+    case 0x08:
+    case 0x10:
+      value = (cmd == 0x08) ? _delayTime : (uint16_t)_temperature;
+      data[0] = value;
+      data[1] = value >> 8;
+      sendFrame(timeUs, cmd, data, 2, true);
+      return;
+    case 0x04:
+    case 0x06:
+    case 0x0a:
+    case 0x0c:
+      data[0] = getRegister(cmd);
+      sendFrame(timeUs, cmd, data, 1, true);
+      return;
+    case 0x0d:
+      sendFrame(timeUs, cmd, NULL, 0, true);
+      _sleeping = true;
+      return;
+    case 0x0f:
+      sendFrame(timeUs, cmd, NULL, 0, true);
+      restoreRegisters();
+      _busyUntil = timeUs + 1000000;
+      _powerOnAt = _busyUntil;
+      return;
+    default:
+      break;
+    }
+  }
+  else if ((len == 1 && (cmd == 0x05 || cmd == 0x07 || cmd == 0x0b)) || (len == 2 && cmd == 0x09))
+  {
+    value = (len == 2) ? (((uint16_t)_rx[4] << 8) | _rx[3]) : _rx[3];
+    setRegister(cmd - 1, value);
+    sendFrame(timeUs, cmd, _rx + 3, len, true);
+    return;
+  }
+  sendFrame(timeUs, 0xab, NULL, 0, true); // Unknown command
+}
+
+/* Serialise a frame on the line, applying the configured faults */
+void BM22S402x_1_Sim::sendFrame(uint64_t timeUs, uint8_t cmd, const uint8_t data[], uint8_t len, bool isReply)
+{
+  uint8_t i, checkSum = cmd + len;
+  if (isReply && chance(_replyLossRate))
+  {
+    return;
+  }
+  if (chance(_noiseRate))
+  {
+    for (i = random() % 4 + 1; i > 0; i--)
+    {
+      sendByte(timeUs, random());
+      noiseBytes++;
+    }
+  }
+  sendByte(timeUs, 0xfb);
+  sendByte(timeUs, cmd);
+  sendByte(timeUs, len);
+  for (i = 0; i < len; i++)
+  {
+    sendByte(timeUs, data[i]);
+    checkSum += data[i];
+  }
+  if (chance(_corruptRate))
+  {
+    checkSum ^= 0x5a;
+    framesCorrupted++;
+  }
+  sendByte(timeUs, checkSum);
+  if (isReply)
+  {
+    repliesSent++;
+  }
+}
+
+void BM22S402x_1_Sim::sendByte(uint64_t timeUs, uint8_t data)
+{
+  uint64_t start = (timeUs > _lineFreeAt) ? timeUs : _lineFreeAt;
+  _lineFreeAt = start + _byteTime;
+  bytesSent++;
+  if (chance(_dropRate))
+  {
+    bytesDropped++;
+    return;
+  }
+  _port.deliver(data, _lineFreeAt);
+}
+
+/* PIR STATUS register: bit0 triggered, bit3 PIR enabled, bit5 stable */
+uint8_t BM22S402x_1_Sim::statusBits(uint64_t timeUs)
+{
+  uint8_t status = _control & 0x08;
+  if (timeUs >= _powerOnAt + (uint64_t)_warmupTime * 1000)
+  {
+    status |= 0x20;
+    if ((_control & 0x08) && isMotion(timeUs))
+    {
+      status |= 0x01;
+    }
+  }
+  return status;
+}
+
+bool BM22S402x_1_Sim::isMotion(uint64_t timeUs)
+{
+  if (_motionPeriod == 0)
+  {
+    return _motion;
+  }
+  return (timeUs / 1000) % _motionPeriod < _motionActive;
+}
+
+void BM22S402x_1_Sim::restoreRegisters()
+{
+  _control = 0x6b;
+  _sensitivity = 0;
+  _delayTime = 30;
+  _blockTime = 5;
+}
+
+/* xorshift32, deterministic for a given seed */
+uint32_t BM22S402x_1_Sim::random()
+{
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+bool BM22S402x_1_Sim::chance(double rate)
+{
+  if (rate <= 0)
+  {
+    return false;
+  }
+  return (random() & 0xffffff) < rate * 0x1000000;
+}
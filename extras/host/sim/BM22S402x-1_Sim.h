@@ -0,0 +1,90 @@
+/*****************************************************************
+File:             BM22S402x-1_Sim.h
+Author:           BESTMODULES
+Description:      Software model of a BM22S402x-1 module for the host
+                  build: command replies, AUTO mode packets, STATUS
+                  pin and fault injection
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#ifndef _BM22S402x_1_SIM_H_
+#define _BM22S402x_1_SIM_H_
+
+#include <Arduino.h>
+
+class BM22S402x_1_Sim : public HostSerialDevice
+{
+public:
+  BM22S402x_1_Sim(HostSerialPort &port, uint32_t seed = 1);
+
+  /* Behaviour */
+  void setPacketInterval(uint32_t ms);
+  void setReplyDelay(uint32_t us);
+  void setBaud(uint32_t baud);
+  void setWarmupTime(uint32_t ms);
+  void setStatusPin(uint8_t pin);
+  void setMotion(bool isActive);
+  void setMotionPattern(uint32_t periodMs, uint32_t activeMs);
+  void setTemperature(int16_t temperature);
+  void setDeviceID(const uint8_t devID[10]);
+  void setRegister(uint8_t readCmd, uint16_t value);
+  uint16_t getRegister(uint8_t readCmd);
+  void powerOn();
+
+  /* Fault injection, probabilities in 0.0~1.0 */
+  void setNoiseRate(double rate);
+  void setDropRate(double rate);
+  void setCorruptRate(double rate);
+  void setReplyLossRate(double rate);
+
+  /* Counters */
+  uint32_t packetsSent;
+  uint32_t repliesSent;
+  uint32_t commandsReceived;
+  uint32_t bytesSent;
+  uint32_t bytesDropped;
+  uint32_t framesCorrupted;
+  uint32_t noiseBytes;
+
+  void receive(uint8_t data);
+  void service();
+
+private:
+  HostSerialPort &_port;
+  uint32_t _seed;
+  uint32_t _packetInterval = 100;
+  uint32_t _replyDelay = 1000;
+  uint32_t _byteTime = 261; // 10 bits at 38400 bps
+  uint32_t _warmupTime = 2000;
+  uint8_t _statusPin = 0xff;
+  bool _motion = false;
+  uint32_t _motionPeriod = 0;
+  uint32_t _motionActive = 0;
+  int16_t _temperature = 250;
+  uint8_t _devID[10];
+  uint8_t _control, _sensitivity, _blockTime;
+  uint16_t _delayTime;
+  double _noiseRate = 0, _dropRate = 0, _corruptRate = 0, _replyLossRate = 0;
+
+  uint64_t _powerOnAt = 0;
+  uint64_t _nextPacketAt = 0;
+  uint64_t _lineFreeAt = 0;
+  uint64_t _busyUntil = 0; // Reset in progress
+  bool _sleeping = false;
+  uint32_t _phase = 0;     // PIR waveform phase
+  uint8_t _rx[8];
+  uint8_t _rxLen = 0;
+
+  void generateUntil(uint64_t timeUs);
+  void sendPacket(uint64_t timeUs);
+  void handleCommand(uint64_t timeUs);
+  void sendFrame(uint64_t timeUs, uint8_t cmd, const uint8_t data[], uint8_t len, bool isReply);
+  void sendByte(uint64_t timeUs, uint8_t data);
+  uint8_t statusBits(uint64_t timeUs);
+  bool isMotion(uint64_t timeUs);
+  void restoreRegisters();
+  uint32_t random();
+  bool chance(double rate);
+};
+
+#endif
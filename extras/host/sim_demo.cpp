@@ -0,0 +1,678 @@
+/*****************************************************************
+File:          sim_demo.cpp
+Author:        BESTMODULES
+Description:   Drives the library against BM22S402x_1_Sim on the host:
+               configuration, warm-up, AUTO mode stream with and
+               without injected line faults
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include <stdio.h>
+#include "BM22S402x-1.h"
+#include "BM22S402x-1_Bus.h"
+#include "BM22S402x-1_Capture.h"
+#include "BM22S402x-1_Group.h"
+#include "BM22S402x-1_Occupancy.h"
+#include "BM22S402x-1_Power.h"
+#include "BM22S402x-1_Sim.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+  printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+  failures += condition ? 0 : 1;
+}
+
+static uint32_t triggers = 0, releases = 0, stables = 0, packetEvents = 0, errors = 0;
+static void countTrigger(uint32_t) { triggers++; }
+static void countRelease(uint32_t) { releases++; }
+static void countStable(uint32_t) { stables++; }
+static void countPacket(const BM22S402x_1_Sample &) { packetEvents++; }
+static void countError(uint8_t, uint8_t) { errors++; }
+
+/* Multiplexer in front of several modules: the channel whose select pin is HIGH drives the line */
+class MuxLink : public BM22S402x_1_Transport
+{
+public:
+  HardwareSerial channels[3];
+  uint8_t pins[3] = {20, 21, 22};
+  uint32_t collisions = 0;
+  void begin(uint32_t baud)
+  {
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      channels[i].begin(baud);
+    }
+  }
+  uint8_t read(uint8_t buf[], uint8_t len)
+  {
+    HardwareSerial *port = selected();
+    uint8_t n = 0;
+    while (port != NULL && n < len && port->available() > 0)
+    {
+      buf[n++] = port->read();
+    }
+    return n;
+  }
+  void write(const uint8_t buf[], uint8_t len)
+  {
+    HardwareSerial *port = selected();
+    if (port != NULL)
+    {
+      port->write(buf, len);
+    }
+  }
+
+private:
+  HardwareSerial *selected()
+  {
+    HardwareSerial *port = NULL;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      if (digitalRead(pins[i]) == HIGH)
+      {
+        collisions += (port != NULL) ? 1 : 0;
+        port = &channels[i];
+      }
+    }
+    return port;
+  }
+};
+
+/* Count packets received during ms of simulated time */
+static uint32_t streamFor(BM22S402x_1 &pir, uint32_t ms)
+{
+  uint32_t packets = 0, end = millis() + ms;
+  while (millis() < end)
+  {
+    packets += pir.isInfoAvailable();
+    hostAdvance(500);
+  }
+  hostAdvance(5000); // Let the last packet finish arriving
+  packets += pir.isInfoAvailable();
+  return packets;
+}
+
+/* Full history overwrites the oldest samples and counts them */
+static void checkHistory()
+{
+  BM22S402x_1_History<4> history;
+  BM22S402x_1_Sample sample = {}, samples[4];
+  uint8_t i, n;
+  for (i = 0; i < 6; i++)
+  {
+    sample.rawPIR = i;
+    history.write(sample);
+  }
+  check(history.available() == 4 && history.getDropCount() == 2 && history.peek(sample) && sample.rawPIR == 2,
+        "history keeps the newest samples");
+  n = history.read(samples, 4);
+  check(n == 4 && samples[0].rawPIR == 2 && samples[3].rawPIR == 5 && history.available() == 0 && !history.read(sample),
+        "history reads oldest first");
+}
+
+/* STATUS pin edges: order, overflow of the edge queue and the cross-check against packets */
+static void checkStatusPin()
+{
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 5);
+  BM22S402x_1_StatusEvent event;
+  uint32_t edges = 0, lastTime = 0;
+  bool isOrdered = true, expected = true;
+
+  sim.setWarmupTime(0);
+  sim.setMotionPattern(2000, 500);
+  sim.setStatusPin(2);
+  pir.begin(2);
+  streamFor(pir, 6000); // Three motion periods
+  while (pir.readStatusEvent(event))
+  {
+    isOrdered = isOrdered && event.isTrigger == expected && event.timeMs >= lastTime;
+    expected = !expected;
+    lastTime = event.timeMs;
+    edges++;
+  }
+  printf("status pin: %u edges, ordered %d, %u dropped, %u mismatches\n", (unsigned)edges, isOrdered,
+         (unsigned)pir.getStatusEventDropCount(), (unsigned)pir.getStatusMismatchCount());
+  check(isOrdered && edges >= 5 && edges <= 7 && pir.getStatusEventDropCount() == 0, "STATUS pin edges queued in order");
+  check(pir.getStatusMismatchCount() <= edges, "STATUS pin agrees with the packet trigger bit");
+
+  streamFor(pir, 20000); // 20 edges, nobody reads them
+  edges = 0;
+  while (pir.readStatusEvent(event))
+  {
+    edges++;
+  }
+  printf("status pin overflow: %u read, %u dropped\n", (unsigned)edges, (unsigned)pir.getStatusEventDropCount());
+  check(edges == BM22S402x_1_EVENT_QUEUE_SIZE - 1 && pir.getStatusEventDropCount() >= 20 - edges,
+        "STATUS pin edge queue counts overflow");
+}
+
+/* Destroyed modules give their STATUS pin interrupt back */
+static void checkStatusIrqRelease()
+{
+  HardwareSerial port;
+  BM22S402x_1_StatusEvent event;
+  uint8_t i, edges = 0;
+  for (i = 0; i < BM22S402x_1_STATUS_IRQ_MAX + 1; i++)
+  {
+    BM22S402x_1 pir(&port);
+    pir.begin(3);
+  }
+  BM22S402x_1 pir(&port);
+  pir.begin(3);
+  hostSetPin(3, HIGH); // Both edges before the next update(): only an interrupt sees them
+  hostSetPin(3, LOW);
+  while (pir.readStatusEvent(event))
+  {
+    edges++;
+  }
+  check(edges == 2, "destroyed modules free their STATUS pin interrupt");
+  pir.end();
+  hostSetPin(3, HIGH);
+  hostSetPin(3, LOW);
+  check(!pir.readStatusEvent(event), "end() stops STATUS pin capture");
+}
+
+/* applyConfig(): the sensitivity write succeeds, then the line loses every reply */
+static BM22S402x_1_Sim *rollbackSim = NULL;
+static bool isRollbackRestored = false, isRollbackArmed = false;
+static void loseRepliesAfterSensitivity(uint8_t cmd, uint8_t status, uint16_t)
+{
+  if (cmd == 0x07 && status == WRITE_OK && isRollbackArmed)
+  {
+    isRollbackArmed = false; // Not again for the rollback write
+    rollbackSim->setReplyLossRate(1.0);
+  }
+  else if (cmd == 0x09 && status != WRITE_OK && isRollbackRestored)
+  {
+    rollbackSim->setReplyLossRate(0.0); // Line recovers in time for the rollback
+  }
+}
+
+static void checkApplyRollback()
+{
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 14);
+  BM22S402x_1_Config config;
+  uint8_t failed = 0, status;
+
+  sim.setPacketInterval(0);
+  pir.begin();
+  rollbackSim = &sim;
+  pir.onReply(loseRepliesAfterSensitivity);
+  config.PIRControl = 0x6b;
+  config.sensitivity = L3;
+  config.delayTime = 60;
+  config.blockTime = 5;
+  isRollbackRestored = true;
+  isRollbackArmed = true;
+  status = pir.applyConfig(config, &failed);
+  check(status == TIMEOUT_ERROR && failed == 0x04 && sim.getRegister(0x06) == 0, "applyConfig rolls back a partial write");
+
+  pir.onReply(NULL);
+  pir.applyConfig(config); // Both land; the cache now holds them
+  config.sensitivity = L5;
+  config.delayTime = 90;
+  pir.onReply(loseRepliesAfterSensitivity);
+  isRollbackRestored = false;
+  isRollbackArmed = true;
+  status = pir.applyConfig(config, &failed);
+  check(status == TIMEOUT_ERROR && failed == (0x04 | 0x20), "applyConfig reports a rollback write that failed");
+  pir.onReply(NULL);
+  sim.setReplyLossRate(0.0);
+}
+
+/* Handlers that submit commands from inside update() */
+static BM22S402x_1 *handlerPir = NULL;
+static uint32_t handlerPackets = 0, handlerReplies = 0;
+static void submitFromPacket(const BM22S402x_1_Sample &)
+{
+  handlerPackets++;
+  handlerPir->submitCommand(0x0c);
+}
+static void countHandlerPacket(const BM22S402x_1_Sample &) { handlerPackets++; }
+static void submitFromReply(uint8_t, uint8_t status, uint16_t)
+{
+  handlerReplies += (status == READ_OK) ? 1 : 0;
+  handlerPir->submitCommand(0x0c);
+}
+
+static void checkHandlerCommands()
+{
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 9);
+  uint32_t start, i;
+
+  sim.setWarmupTime(0);
+  sim.setPacketInterval(10); // Several packets arrive per update()
+  pir.begin();
+  handlerPir = &pir;
+  pir.onPacket(submitFromPacket);
+  hostAdvance(100000);
+  pir.update();
+  start = sim.packetsSent - handlerPackets;
+  for (i = 0; i < 40; i++)
+  {
+    hostAdvance(50000);
+    pir.update();
+  }
+  printf("handler commands: %u/%u packets\n", (unsigned)handlerPackets, (unsigned)(sim.packetsSent - start));
+  check(handlerPackets == sim.packetsSent - start && handlerPackets > 30, "onPacket handler submitting a command loses no packet");
+
+  pir.onPacket(countHandlerPacket);
+  pir.onReply(submitFromReply);
+  pir.submitCommand(0x0c);
+  start = sim.packetsSent - handlerPackets;
+  for (i = 0; i < 40; i++)
+  {
+    hostAdvance(50000);
+    pir.update();
+  }
+  printf("handler commands: %u replies, %u/%u packets\n", (unsigned)handlerReplies, (unsigned)handlerPackets,
+         (unsigned)(sim.packetsSent - start));
+  check(handlerReplies > 30 && handlerPackets == sim.packetsSent - start, "onReply handler chaining commands loses no packet");
+#if BM22S402x_1_STATS
+  check(pir.getStats().packetsReceived > 0 && pir.getStats().packetsDropped == 0, "packets taken by a handler are not counted as dropped");
+#endif
+  pir.onReply(NULL);
+  while (pir.isBusy())
+  {
+    hostAdvance(10000);
+    pir.update();
+  }
+}
+
+/* Every packet of every module reaches the group's event stream */
+static void checkGroupEvents()
+{
+  HardwareSerial ports[2];
+  BM22S402x_1 a(&ports[0]), b(&ports[1]);
+  BM22S402x_1_Sim simA(ports[0], 11), simB(ports[1], 12);
+  BM22S402x_1_Group group;
+  BM22S402x_1_GroupEvent event;
+  uint32_t start[2], packets[2] = {0, 0}, i;
+
+  simA.setWarmupTime(0);
+  simB.setWarmupTime(0);
+  simA.setPacketInterval(10); // Several packets arrive per update()
+  simB.setPacketInterval(20);
+  group.add(a);
+  group.add(b);
+  group.begin();
+  hostAdvance(100000);
+  group.update();
+  while (group.readEvent(event))
+  {
+  }
+  start[0] = simA.packetsSent;
+  start[1] = simB.packetsSent;
+  for (i = 0; i < 40; i++)
+  {
+    hostAdvance(50000);
+    group.update();
+    while (group.readEvent(event))
+    {
+      packets[event.sensor] += (event.type == BM22S402x_1_EVENT_PACKET) ? 1 : 0;
+    }
+  }
+  printf("group events: %u/%u and %u/%u packets, %u dropped\n", (unsigned)packets[0], (unsigned)(simA.packetsSent - start[0]),
+         (unsigned)packets[1], (unsigned)(simB.packetsSent - start[1]), (unsigned)group.getEventDropCount());
+  check(packets[0] == simA.packetsSent - start[0] && packets[1] == simB.packetsSent - start[1] && packets[0] > 100 &&
+            group.getEventDropCount() == 0,
+        "group reports every packet of every module");
+}
+
+/* Sketch commands queued around the power manager's own must not be taken for its replies */
+static void checkPowerQueue()
+{
+  HardwareSerial port;
+  BM22S402x_1 pir(&port);
+  BM22S402x_1_Sim sim(port, 13);
+  BM22S402x_1_PowerManager power(pir);
+  uint32_t i, sketchCommands = 0, start = millis();
+  bool isEarlyReady = false;
+
+  sim.setWarmupTime(2000);
+  sim.setPacketInterval(0);
+  sim.setRegister(0x08, 0x20); // Stable bit of a 0x0C reply if mistaken for one
+  pir.begin();
+  power.setDutyCycle(500, 1000);
+  power.begin();
+  for (i = 0; i < 1500; i++)
+  {
+    power.update();
+    if (i % 20 == 0 && pir.submitCommand(0x08)) // Lands behind or ahead of the manager's 0x0C/0x0D
+    {
+      sketchCommands++;
+    }
+    isEarlyReady = isEarlyReady || (power.isReady() && millis() - start < 1900);
+    hostAdvance(1000);
+  }
+  printf("power queue: %u sketch commands, %u ms asleep\n", (unsigned)sketchCommands, (unsigned)power.getMetrics().sleepMs);
+  check(!isEarlyReady && sketchCommands > 50, "power manager ignores sketch replies while warming up");
+  for (i = 0; i < 5000 && !power.isReady(); i++)
+  {
+    power.update();
+    if (i % 20 == 0)
+    {
+      pir.submitCommand(0x08);
+    }
+    hostAdvance(1000);
+  }
+  check(power.isReady() && millis() - start >= 2000, "power manager ready once the module is stable");
+}
+
+int main()
+{
+  BM22S402x_1 pir(&Serial1);
+  BM22S402x_1_Sim sim(Serial1);
+  BM22S402x_1_Registers regs;
+  BM22S402x_1_Config config;
+  uint8_t devID[10], failed = 0xff;
+  uint32_t start, packets;
+
+  checkHistory();
+  pir.begin();
+  check(pir.getDevID(devID) == READ_OK && devID[0] == 0x42, "getDevID");
+  check(pir.readAllRegisters(regs) == READ_OK && regs.PIRControl == 0x6b && regs.delayTime == 30, "readAllRegisters");
+
+  config.PIRControl = 0x6b;
+  config.sensitivity = L3;
+  config.delayTime = 30;
+  config.blockTime = 5;
+  start = sim.commandsReceived;
+  check(pir.applyConfig(config, &failed) == WRITE_OK && failed == 0, "applyConfig");
+  check(sim.commandsReceived - start == 1 && sim.getRegister(0x06) == L3, "applyConfig writes only the changed register");
+  check(pir.write<BM22S402x_1::Cmd::SetDelayTime>(300) == WRITE_OK && pir.read<BM22S402x_1::Cmd::DelayTime>() == 300, "typed 16-bit register access");
+  pir.write<BM22S402x_1::Cmd::SetDelayTime>(30);
+  sim.setTemperature(-53);
+  check(pir.readTemperatureDeci() == -53 && pir.readTemperatureDeci(true) == 225, "fixed-point temperature");
+  sim.setTemperature(250);
+
+  pir.onTrigger(countTrigger);
+  pir.onRelease(countRelease);
+  pir.onStable(countStable);
+  pir.onPacket(countPacket);
+  pir.onError(countError);
+  start = millis();
+  while (pir.isStable() == false)
+  {
+    hostAdvance(1000);
+  }
+  printf("stable after %u ms\n", (unsigned)(millis() - start));
+
+  sim.setMotion(true);
+  hostAdvance(200000);
+  check(pir.isTrigger(), "isTrigger with motion");
+  sim.setMotion(false);
+  hostAdvance(200000);
+  check(!pir.isTrigger(), "isTrigger without motion");
+  hostAdvance(200000);
+  start = micros();
+  pir.isTrigger();
+  check(micros() - start < 1000 && pir.isInfoAvailable(), "isTrigger in AUTO mode neither blocks nor takes the packet");
+
+  BM22S402x_1_SignalProcessor<4> processor;
+  pir.attachProcessor(&processor);
+  streamFor(pir, 3000);
+  check(!processor.isTriggered() && processor.getTriggerCount() == 0, "processor quiet without motion");
+  sim.setMotion(true);
+  streamFor(pir, 2000);
+  check(processor.getTriggerCount() > 0, "processor detects motion");
+  sim.setMotion(false);
+  streamFor(pir, 6000);
+  printf("processor: baseline %u, %u triggers\n", processor.getBaseline(), (unsigned)processor.getTriggerCount());
+  check(!processor.isTriggered(), "processor releases after motion");
+  pir.attachProcessor(NULL);
+  check(stables == 1 && triggers == 2 && releases == 2, "trigger, release and stable callbacks");
+
+  start = sim.packetsSent;
+  packetEvents = 0;
+  for (packets = 0; packets < 5000; packets++)
+  {
+    pir.update();
+    hostAdvance(1000);
+  }
+  check(packetEvents == sim.packetsSent - start, "packet callback from update()");
+  sim.setReplyLossRate(1.0);
+  pir.readCommand(0x06);
+  sim.setReplyLossRate(0);
+  check(errors == 1, "error callback");
+  pir.isInfoAvailable(); // Consume the packet that arrived during the failed read
+
+  pir.setPreserveStream(true);
+  while (!pir.isInfoAvailable())
+  {
+    hostAdvance(1000);
+  }
+  hostAdvance(100000); // Next packet waits in the UART FIFO
+  pir.readCommand(0x06);
+  check(pir.isInfoAvailable(), "packet queued before a command is preserved");
+
+  /* Commands interleaved with the stream: replies and packets are demultiplexed */
+  uint32_t commands = 0, commandErrors = 0;
+  start = sim.packetsSent;
+  packetEvents = 0;
+  for (packets = 0; packets < 10000; packets++)
+  {
+    if (!pir.isBusy())
+    {
+      commandErrors += (commands > 0 && pir.getCommandStatus() != READ_OK);
+      pir.submitCommand(0x06);
+      commands++;
+    }
+    pir.update();
+    hostAdvance(500);
+  }
+  printf("interleaved: %u commands, %u packets of %u\n", (unsigned)commands, (unsigned)packetEvents,
+         (unsigned)(sim.packetsSent - start));
+  check(commandErrors == 0 && packetEvents == sim.packetsSent - start, "no packet lost while commands run");
+  pir.isInfoAvailable(); // Packets above were taken by the callback
+
+  /* Duty cycling: 500 ms windows, 2000 ms sleep */
+  BM22S402x_1_PowerManager power(pir);
+  uint32_t readyWindows = 0, sleepPackets = 0, sentBefore;
+  bool wasReady = false;
+  power.setDutyCycle(500, 2000);
+  power.begin();
+  for (packets = 0; packets < 12500; packets++)
+  {
+    sentBefore = sim.packetsSent;
+    power.update();
+    readyWindows += (power.isReady() && !wasReady);
+    wasReady = power.isReady();
+    hostAdvance(1000);
+    sleepPackets += power.isAwake() ? 0 : sim.packetsSent - sentBefore;
+  }
+  const BM22S402x_1_PowerMetrics &metrics = power.getMetrics();
+  printf("power: awake %u ms, asleep %u ms, UART active %u ms, %u wake-ups\n", (unsigned)metrics.awakeMs,
+         (unsigned)metrics.sleepMs, (unsigned)metrics.uartActiveMs, (unsigned)metrics.wakeCount);
+  check(metrics.wakeCount == 4 && readyWindows == 5 && sleepPackets == 0, "duty cycle sleeps and wakes the module");
+  while (!power.isAwake())
+  {
+    power.update();
+    hostAdvance(1000);
+  }
+  pir.isInfoAvailable();
+
+  start = sim.packetsSent;
+  packets = streamFor(pir, 5000);
+  printf("clean line: %u/%u packets\n", (unsigned)packets, (unsigned)(sim.packetsSent - start));
+  check(packets == sim.packetsSent - start, "no packet lost on a clean line");
+
+  sim.setNoiseRate(0.3);
+  sim.setDropRate(0.002);
+  sim.setCorruptRate(0.05);
+  start = sim.packetsSent;
+  packets = streamFor(pir, 20000);
+  printf("faulty line: %u/%u packets, %u corrupted, %u bytes dropped\n", (unsigned)packets,
+         (unsigned)(sim.packetsSent - start), (unsigned)sim.framesCorrupted, (unsigned)sim.bytesDropped);
+  check(packets > (sim.packetsSent - start) * 8 / 10, "framer recovers from line faults");
+
+  check(pir.stableSince() != 0 && pir.getTimeToStable() == 0, "stable bit tracked without polling");
+  check(pir.reset() == WRITE_OK && pir.stableSince() == 0, "reset restarts the warm-up tracker");
+  uint32_t estimate = pir.getTimeToStable();
+  start = millis();
+  while (pir.stableSince() == 0)
+  {
+    hostAdvance(1000);
+  }
+  start = millis() - start;
+  printf("warm-up after reset: %u ms, estimated %u ms\n", (unsigned)start, (unsigned)estimate);
+  check(estimate + 200 > start && estimate < start + 200, "time-to-stable learned from the first warm-up");
+
+#if BM22S402x_1_STATS
+  const BM22S402x_1_Stats &stats = pir.getStats();
+  const BM22S402x_1_Latency &read04 = stats.latency[0x04];
+  printf("stats: framesOK %u, checksumErrors %u, timeouts %u, cmdErrors %u, resyncBytes %u, packets %u/%u dropped\n",
+         (unsigned)stats.framesOK, (unsigned)stats.checksumErrors, (unsigned)stats.timeouts, (unsigned)stats.cmdErrors,
+         (unsigned)stats.resyncBytes, (unsigned)stats.packetsDropped, (unsigned)stats.packetsReceived);
+  check(stats.checksumErrors > 0 && stats.resyncBytes > 0, "statistics count line faults");
+  check(stats.retries >= BM22S402x_1_RETRIES, "failed commands are resent");
+  check(read04.count == 1 && read04.minUs == read04.maxUs && read04.histogram[3] == 1, "statistics record 0x04 latency");
+#endif
+
+  /* Record a faulty stream on a second module, replay it 4 times as fast */
+  static uint8_t recording[8192];
+  BM22S402x_1_HardSerial link2(&Serial2);
+  BM22S402x_1_RecordingTransport recorder(link2, recording, sizeof(recording));
+  BM22S402x_1 recorded(&recorder);
+  BM22S402x_1_Sim sim2(Serial2, 7);
+  sim2.setWarmupTime(0);
+  sim2.setMotionPattern(1000, 300);
+  sim2.setNoiseRate(0.2);
+  sim2.setCorruptRate(0.05);
+  recorded.begin();
+  packets = streamFor(recorded, 3000);
+  check(recorder.getDropped() == 0 && recorder.getSize() > 0, "stream recorded into RAM");
+
+  BM22S402x_1_ReplayTransport player(recorder.getData(), recorder.getSize());
+  BM22S402x_1 replayed(&player);
+  uint32_t replayPackets = 0;
+  player.setSpeed(4);
+  replayed.begin();
+  start = millis();
+  while (!player.isDone())
+  {
+    replayPackets += replayed.isInfoAvailable();
+    hostAdvance(500);
+  }
+  replayPackets += replayed.isInfoAvailable();
+  start = millis() - start;
+  printf("replay: %u/%u packets in %u ms\n", (unsigned)replayPackets, (unsigned)packets, (unsigned)start);
+  check(replayPackets == packets && start < 3100 / 4, "replay reproduces the recorded stream");
+#if BM22S402x_1_STATS
+  check(replayed.getStats().checksumErrors == recorded.getStats().checksumErrors, "replay reproduces line faults");
+#endif
+
+  /* Occupancy aggregation over 2 s windows: motion for 1 s every 4 s */
+  BM22S402x_1 room(&Serial3);
+  BM22S402x_1_Sim sim3(Serial3, 3);
+  BM22S402x_1_OccupancyTracker<8> occupancy;
+  BM22S402x_1_OccupancyWindow window;
+  uint32_t windowTriggers = 0, windowActive = 0, index;
+  sim3.setWarmupTime(0);
+  sim3.setMotionPattern(4000, 1000);
+  room.begin();
+  occupancy.setWindow(2000);
+  room.attachOccupancy(&occupancy);
+  room.onTrigger(countTrigger);
+  triggers = 0;
+  streamFor(room, 20000);
+  for (index = 0; occupancy.getWindow(index, window); index++)
+  {
+    windowTriggers += window.triggerCount;
+    windowActive += window.activeMs;
+  }
+  printf("occupancy: %u triggers, active %u ms, longest idle %u ms, %u/h, %u windows\n",
+         (unsigned)occupancy.getTriggerCount(), (unsigned)occupancy.getActiveTime(), (unsigned)occupancy.getLongestIdle(),
+         (unsigned)occupancy.getTriggerRate(), (unsigned)occupancy.getWindowCount());
+  check(occupancy.getWindowCount() == 9 && windowActive <= occupancy.getActiveTime(), "occupancy windows");
+  check(occupancy.getTriggerCount() == triggers && occupancy.getTriggerCount() >= 5, "occupancy trigger count");
+  check(occupancy.getActiveTime() > 4000 && occupancy.getActiveTime() < 6500 && occupancy.getLongestIdle() > 2500 &&
+            occupancy.getLongestIdle() < 3500,
+        "occupancy active time and idle gap");
+
+  /* Three modules on one line: identified by device ID, polled through a group */
+  MuxLink mux;
+  BM22S402x_1_SharedBus bus(mux);
+  BM22S402x_1 node0(bus.addDevice(mux.pins[0])), node1(bus.addDevice(mux.pins[1])), node2(bus.addDevice(mux.pins[2]));
+  BM22S402x_1_Sim busSim0(mux.channels[0], 10), busSim1(mux.channels[1], 11), busSim2(mux.channels[2], 12);
+  BM22S402x_1_Sim *busSims[3] = {&busSim0, &busSim1, &busSim2};
+  BM22S402x_1 *nodes[3] = {&node0, &node1, &node2};
+  BM22S402x_1_Group busGroup;
+  uint16_t values[3];
+  uint8_t ids[3][10], identified = 0;
+  uint32_t serialTime;
+  for (index = 0; index < 3; index++)
+  {
+    memcpy(ids[index], devID, 10);
+    ids[index][9] = 0xa0 + index;
+    busSims[index]->setDeviceID(ids[index]);
+    busSims[index]->setPacketInterval(0); // Command mode only on a shared line
+    busSims[index]->setRegister(0x04, 0x60 + index);
+    busGroup.add(*nodes[index]);
+  }
+  busGroup.begin();
+  for (index = 0; index < 3; index++)
+  {
+    identified += bus.identify(index, *nodes[index]);
+  }
+  check(identified == 3 && bus.indexOf(ids[2]) == 2 && bus.indexOf(ids[0]) == 0, "modules on a shared line identified by ID");
+  check(busGroup.readAll(0x04, values) == 0 && values[0] == 0x60 && values[1] == 0x61 && values[2] == 0x62,
+        "replies on a shared line matched to their module");
+  start = millis();
+  for (index = 0; index < 30; index++)
+  {
+    node0.writeCommand(0x07, index & 0x07);
+  }
+  serialTime = millis() - start;
+  start = millis();
+  for (index = 0; index < 10; index++)
+  {
+    failed = busGroup.writeAll(0x07, index & 0x07);
+  }
+  start = millis() - start;
+  printf("shared line: 30 writes to one module %u ms, to three modules %u ms, %u grants, %u waits\n",
+         (unsigned)serialTime, (unsigned)start, (unsigned)bus.getGrantCount(), (unsigned)bus.getWaitCount());
+  check(failed == 0 && start < serialTime && mux.collisions == 0 && bus.getOwner() == 0xff,
+        "shared line interleaves modules during the write interval");
+
+  /* A module waited on while another holds the line gives up instead of hanging */
+  uint8_t lineRecordBuf[64], lineID[10];
+  BM22S402x_1_RecordingTransport lineRecorder(*bus.addDevice(0xff), lineRecordBuf, sizeof(lineRecordBuf));
+  node0.submitCommand(0x0c);
+  while (bus.getOwner() != 0)
+  {
+    node0.update(); // Until the communication interval has passed and the request is out
+    yield();
+  }
+  start = millis();
+  node1.readCommand(0x0c);
+  start = millis() - start;
+  check(node1.getCommandStatus() == TIMEOUT_ERROR && start < BM22S402x_1_LINE_TIMEOUT + 50 && !lineRecorder.acquire(),
+        "blocking command fails while another module holds the line");
+  while (node0.isBusy())
+  {
+    node0.update();
+    yield();
+  }
+  check(node0.getCommandStatus() == READ_OK && node1.getDevID(lineID) == READ_OK && bus.indexOf(lineID) == 1,
+        "shared line is usable once the holder completes");
+  check(lineRecorder.acquire() && bus.getOwner() == 3, "recording link acquires the shared line");
+  lineRecorder.release();
+  check(bus.getOwner() == 0xff, "recording link releases the shared line");
+
+  checkHandlerCommands();
+  checkGroupEvents();
+  checkPowerQueue();
+  checkStatusIrqRelease();
+  checkApplyRollback();
+  checkStatusPin(); // Last: it runs the clock past the warm-ups measured above
+  return failures == 0 ? 0 : 1;
+}
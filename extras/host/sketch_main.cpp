@@ -0,0 +1,42 @@
+/*****************************************************************
+File:          sketch_main.cpp
+Author:        BESTMODULES
+Description:   Runs an example sketch(SKETCH) for a few simulated
+               seconds against BM22S402x_1_Sim
+History:
+V1.0.2   -- initial version; 2026-10-17
+******************************************************************/
+#include <stdio.h>
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include "BM22S402x-1_Sim.h"
+
+#include SKETCH
+
+int main()
+{
+  HostSerialPort *port = SoftwareSerial::find(RX_PIN);
+  uint32_t ledChanges = 0;
+  int led = LOW;
+  if (port == NULL)
+  {
+    port = &Serial1;
+  }
+  BM22S402x_1_Sim sim(*port);
+  sim.setMotionPattern(3000, 1000);
+
+  setup();
+  while (millis() < 10000)
+  {
+    loop();
+    if (digitalRead(STATUS) != led)
+    {
+      led = digitalRead(STATUS);
+      ledChanges++;
+    }
+    hostAdvance(1000);
+  }
+  printf("\nLED changes: %u, packets sent: %u, commands: %u\n",
+         (unsigned)ledChanges, (unsigned)sim.packetsSent, (unsigned)sim.commandsReceived);
+  return (ledChanges > 0 && error == 0) ? 0 : 1;
+}
@@ -4,8 +4,42 @@ Author:        BESTMODULES
 Description:   The sensor with UART and obtain the corresponding value
 History:
 V1.0.1   -- initial version; 2023-2-16; Arduino IDE :v1.8.19
+V1.0.2   -- non-blocking command engine, AUTO mode frame receiver, transports, callbacks; 2026-10-17; Arduino IDE :v1.8.19
 ******************************************************************/
 #include "BM22S402x-1.h"
+#include "BM22S402x-1_Group.h"
+#include "BM22S402x-1_Power.h"
+#include <new>
+
+/* Request and reply data lengths by command code, high/low nibble */
+#define CMD_ENTRY(C) (uint8_t)((BM22S402x_1::Cmd::C::requestLen << 4) | BM22S402x_1::Cmd::C::replyLen)
+static const uint8_t cmdTable[BM22S402x_1_CMD_COUNT] PROGMEM = {
+    0x00,                      // 0x00: none
+    CMD_ENTRY(RawPIR),         // 0x01
+    CMD_ENTRY(FilteredPIR),    // 0x02
+    CMD_ENTRY(DevID),          // 0x03
+    CMD_ENTRY(PIRControl),     // 0x04
+    CMD_ENTRY(SetPIRControl),  // 0x05
+    CMD_ENTRY(Sensitivity),    // 0x06
+    CMD_ENTRY(SetSensitivity), // 0x07
+    CMD_ENTRY(DelayTime),      // 0x08
+    CMD_ENTRY(SetDelayTime),   // 0x09
+    CMD_ENTRY(BlockTime),      // 0x0A
+    CMD_ENTRY(SetBlockTime),   // 0x0B
+    CMD_ENTRY(Status),         // 0x0C
+    CMD_ENTRY(Sleep),          // 0x0D
+    0x00,                      // 0x0E: none
+    CMD_ENTRY(Reset),          // 0x0F
+    CMD_ENTRY(Temperature)     // 0x10
+};
+
+#if BM22S402x_1_STATS
+#define STATS_ADD(field, n) (_stats.field += (n))
+#else
+#define STATS_ADD(field, n)
+#endif
+
+BM22S402x_1 *BM22S402x_1::_statusIrqOwner[BM22S402x_1_STATUS_IRQ_MAX] = {NULL};
 
 /*-------------------------------------  Public  -------------------------------------*/
 /**********************************************************
@@ -15,10 +49,12 @@ Parameters:  statusPin：Status pin connection with Arduino
 Return: None
 Others: None
 **********************************************************/
-BM22S402x_1::BM22S402x_1(HardwareSerial *theSerial)
+BM22S402x_1::BM22S402x_1(HardwareSerial *theSerial) : _hardLink(theSerial)
 {
-  _softSerial = NULL;
-  _hardSerial = theSerial;
+  _transport = &_hardLink;
+#if BM22S402x_1_STATS
+  resetStats();
+#endif
 }
 
 /**********************************************************
@@ -27,14 +63,43 @@ Parameters: statusPin: Status pin connection with Arduino
             rxPin: Receive pin of the UART
             txPin: Send pin of UART
 Return: None
-Others: None
+Others: The first BM22S402x_1_SOFT_SERIAL_MAX links are placed in
+        static storage, further ones are allocated with new. The
+        storage is linked in only by sketches using this constructor;
+        build with BM22S402x_1_SOFT_SERIAL_MAX=0 to always use the heap.
+**********************************************************/
+BM22S402x_1::BM22S402x_1(uint8_t rxPin, uint8_t txPin) : _hardLink(NULL)
+{
+#if BM22S402x_1_SOFT_SERIAL_MAX > 0
+  alignas(BM22S402x_1_SoftSerial) static uint8_t softSerialPool[BM22S402x_1_SOFT_SERIAL_MAX][sizeof(BM22S402x_1_SoftSerial)];
+  static uint8_t softSerialCount = 0;
+  if (softSerialCount < BM22S402x_1_SOFT_SERIAL_MAX)
+  {
+    _transport = new (softSerialPool[softSerialCount++]) BM22S402x_1_SoftSerial(rxPin, txPin);
+  }
+  else
+#endif
+  {
+    _transport = new BM22S402x_1_SoftSerial(rxPin, txPin);
+  }
+#if BM22S402x_1_STATS
+  resetStats();
+#endif
+}
+
+/**********************************************************
+Description: Constructor
+Parameters: transport: UART backend, e.g. a global BM22S402x_1_SoftSerial
+                       or a user class derived from BM22S402x_1_Transport
+Return: None
+Others: The transport must outlive the module object
 **********************************************************/
-BM22S402x_1::BM22S402x_1(uint8_t rxPin, uint8_t txPin)
+BM22S402x_1::BM22S402x_1(BM22S402x_1_Transport *transport) : _hardLink(NULL)
 {
-  _hardSerial = NULL;
-  _rxPin = rxPin;
-  _txPin = txPin;
-  _softSerial = new SoftwareSerial(_rxPin, _txPin);
+  _transport = transport;
+#if BM22S402x_1_STATS
+  resetStats();
+#endif
 }
 
 /**********************************************************
@@ -45,14 +110,92 @@ Others: None
 **********************************************************/
 void BM22S402x_1::begin()
 {
-  if (_softSerial != NULL)
+  startWarmup(millis());
+  _transport->begin(BM22S402x_1_BAUD);
+}
+
+/**********************************************************
+Description: Module initial with STATUS pin monitoring
+Parameters: statusPin: Status pin connection with Arduino
+Return: None
+Others: Edges of the STATUS pin are captured by a pin change
+        interrupt when the pin supports one, otherwise by update().
+        isTrigger() then returns the pin state without using the UART.
+**********************************************************/
+void BM22S402x_1::begin(uint8_t statusPin)
+{
+  int irq;
+  uint8_t i;
+  end(); // Release the interrupt of a previous begin(statusPin)
+  begin();
+  _statusPin = statusPin;
+  pinMode(_statusPin, INPUT);
+  _statusLevel = digitalRead(_statusPin) == HIGH;
+
+  irq = digitalPinToInterrupt(_statusPin);
+#ifdef NOT_AN_INTERRUPT
+  if (irq == NOT_AN_INTERRUPT)
   {
-    _softSerial->begin(BM22S402x_1_BAUD);
+    return; // Edges are polled by update()
   }
-  else
+#endif
+  for (i = 0; i < BM22S402x_1_STATUS_IRQ_MAX; i++)
+  {
+    if (_statusIrqOwner[i] == NULL || _statusIrqOwner[i] == this)
+    {
+      break;
+    }
+  }
+  if (i == BM22S402x_1_STATUS_IRQ_MAX)
+  {
+    return; // No free interrupt slot, edges are polled by update()
+  }
+  _statusIrqOwner[i] = this;
+  _statusIrqSlot = i;
+  switch (i)
+  {
+  case 0:
+    attachInterrupt(irq, statusISR0, CHANGE);
+    break;
+  case 1:
+    attachInterrupt(irq, statusISR1, CHANGE);
+    break;
+  case 2:
+    attachInterrupt(irq, statusISR2, CHANGE);
+    break;
+  default:
+    attachInterrupt(irq, statusISR3, CHANGE);
+    break;
+  }
+}
+
+/**********************************************************
+Description: Stop STATUS pin monitoring
+Parameters: None
+Return: None
+Others: Detaches the pin interrupt and frees its slot for another
+        module; called by the destructor. The UART stays open.
+**********************************************************/
+void BM22S402x_1::end()
+{
+  if (_statusIrqSlot >= 0)
   {
-    _hardSerial->begin(BM22S402x_1_BAUD);
+    detachInterrupt(digitalPinToInterrupt(_statusPin));
+    _statusIrqOwner[_statusIrqSlot] = NULL;
+    _statusIrqSlot = -1;
   }
+  _statusPin = 0xff;
+}
+
+/**********************************************************
+Description: Destructor
+Parameters: None
+Return: None
+Others: Frees the STATUS pin interrupt slot
+**********************************************************/
+BM22S402x_1::~BM22S402x_1()
+{
+  end();
 }
 
 /**********************************************************
@@ -66,18 +209,17 @@ Others: None
 **********************************************************/
 uint8_t BM22S402x_1::getDevID(uint8_t devID[])
 {
-  uint8_t sendBuf[4] = {0xfb, 0x03, 0x00, 0x03};
-  uint8_t recBuf[14], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 14);
+  uint8_t errFlag;
+  waitForReply();
+  submitCommand(Cmd::DevID::code);
+  errFlag = waitForReply();
   if (errFlag == READ_OK)
   {
     for (uint8_t i = 0; i < 10; i++)
     {
-      devID[i] = recBuf[i + 3];
+      devID[i] = _rxBuf[i + 3];
     }
   }
-  delay(10); // Communication interval delay
   return errFlag;
 }
 
@@ -89,26 +231,68 @@ Others: None
 **********************************************************/
 uint16_t BM22S402x_1::readCommand(uint8_t cmd)
 {
-  uint16_t tmp = 0;
-  uint8_t sendBuf[4] = {0xfb, cmd, 0x00, 0x00};
-  uint8_t recBuf[6], recBufLen, errFlag;
-  sendBuf[3] = sendBuf[1] + sendBuf[2];
-  writeBytes(sendBuf, 4);
-  recBufLen = getDataPacketLen(cmd);
-  errFlag = readBytes(recBuf, recBufLen);
-  if (errFlag == READ_OK && cmd == recBuf[1])
+  waitForReply();
+  submitCommand(cmd);
+  if (waitForReply() == READ_OK)
   {
-    if (cmd == 0x08)
-    {
-      tmp = ((uint16_t)recBuf[4] << 8) | recBuf[3];
-    }
-    else
+    return _cmdResult;
+  }
+  return 0;
+}
+
+/**********************************************************
+Description: Read all configuration and status registers
+Parameters: regs: Receives register values and the status of each read
+Return:   0: All registers read ok
+          1: Check error
+          2: Timeout error
+          3: CMD error
+Others: Registers 0x04, 0x06, 0x08, 0x0A and 0x0C are requested
+        back-to-back; each request is sent as soon as the
+        previous reply is validated. On failure the first
+        error is returned and regs.error[] tells which read failed.
+**********************************************************/
+uint8_t BM22S402x_1::readAllRegisters(BM22S402x_1_Registers &regs)
+{
+  waitForReply();
+  requestAllRegisters(regs);
+  waitForReply();
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    if (regs.error[i] != READ_OK)
     {
-      tmp = recBuf[3];
+      return regs.error[i];
     }
   }
-  delay(10); // Communication interval delay
-  return tmp;
+  return READ_OK;
+}
+
+/**********************************************************
+Description: Queue a read of all configuration and status registers
+Parameters: regs: Receives register values and the status of each read
+Return:   1: Reads queued
+          0: Not enough room in the queue or a snapshot is in progress
+Others: Non-blocking version of readAllRegisters(); regs must stay
+        valid until regs.error[4] is no longer BUSY(5).
+**********************************************************/
+bool BM22S402x_1::requestAllRegisters(BM22S402x_1_Registers &regs)
+{
+  const uint8_t cmds[5] = {0x04, 0x06, 0x08, 0x0a, 0x0c};
+  uint8_t i;
+  if (_snapshot != NULL || (BM22S402x_1_QUEUE_SIZE - _queueCount) < 5)
+  {
+    return false;
+  }
+  for (i = 0; i < 5; i++)
+  {
+    regs.error[i] = BUSY;
+  }
+  _snapshot = &regs;
+  for (i = 0; i < 5; i++)
+  {
+    enqueue(cmds[i], REQ_SNAPSHOT, 0);
+  }
+  return true;
 }
 
 /**********************************************************
@@ -120,49 +304,46 @@ Others: None
 **********************************************************/
 bool BM22S402x_1::isStable()
 {
-  bool result = false;
-  uint8_t header[3] = {0xfb, 0x55, 0x07}, recBuf[11] = {0};
-  uint8_t headerLen = 3, recBufLen = 11, targetDataBit = 7, delayCnt = 0;
-  if (_isAutoMode == true)
-  {
-    while (result == false)
-    {
-      result = findPacket(header, headerLen, recBuf, recBufLen);
-      delay(50);
-      delayCnt++;
-      if (delayCnt > 10)
-      {
-        _isAutoMode = false;
-        break;
-      }
-    }
-  }
-  if (_isAutoMode == false)
-  {
-    if ((readCommand(0x0c) & 0x20) == 0x20)
-    {
-      return true;
-    }
-    else
-    {
-      return false;
-    }
-  }
-  if (result == true)
+  update();
+  if (isStreaming())
   {
-    if ((recBuf[targetDataBit] & 0x20) == 0x20)
-    {
-      return true;
-    }
-    else
-    {
-      return false;
-    }
+    yield(); // Keeps while (!isStable()) loops cooperative
+    return _stableSince != 0; // Tracked from the packets as they arrive
   }
-  else
+  return (readCommand(0x0c) & 0x20) == 0x20;
+}
+
+/**********************************************************
+Description: Get the time the module became stable
+Parameters: None
+Return: millis() when the stable bit was first seen set,
+        0 if the module is not known to be stable
+Others: Never blocks; the stable bit is taken from AUTO mode
+        packets and 0x0C replies as they arrive.
+**********************************************************/
+uint32_t BM22S402x_1::stableSince()
+{
+  update();
+  return _stableSince;
+}
+
+/**********************************************************
+Description: Estimate the time until the module is stable
+Parameters: None
+Return: Remaining warm-up time(ms), 0 if stable or overdue
+Others: The warm-up time is learned from warm-ups observed after
+        begin() or reset(); BM22S402x_1_WARMUP_TIME until then.
+**********************************************************/
+uint32_t BM22S402x_1::getTimeToStable()
+{
+  int32_t elapsed;
+  update();
+  if (_stableSince != 0)
   {
-    return false;
+    return 0;
   }
+  elapsed = (int32_t)(millis() - _warmupStart); // Negative while a reset is in progress
+  return (elapsed < (int32_t)_warmupTime) ? _warmupTime - elapsed : 0;
 }
 
 /**********************************************************
@@ -170,65 +351,71 @@ Description: Query whether the module is triggered by a signal
 Parameters: None
 Return:   1: Module is triggered by a signal
           0: The module is not triggered by a signal
-Others: None
+Others: With begin(statusPin) this is a non-blocking read of the
+        STATUS pin. In AUTO mode the bit of the latest packet is
+        returned without blocking; otherwise the UART is queried.
 **********************************************************/
 bool BM22S402x_1::isTrigger()
 {
-  bool result = false;
-  uint8_t header1[3] = {0xfb, 0x55, 0x07}; // auto mode
-  uint8_t header2[3] = {0xfb, 0x0c, 0x01}; // cmd mode
-  uint8_t headerLen = 3, recBufLen, delayCnt;
-  uint8_t recBuf[11] = {0}, targetDataBit;
-
-  if (_isAutoMode == false)
+  update();
+  if (_statusPin != 0xff)
   {
-    delayCnt = 0;
-    recBufLen = 5;
-    targetDataBit = 3;
-    while (result == false)
-    {
-      result = findPacket(header2, headerLen, recBuf, recBufLen);
-      delay(50);
-      delayCnt++;
-      if (delayCnt > 10)
-      {
-        break;
-      }
-    }
+    return _statusLevel;
   }
-  else
+  if (isStreaming())
   {
-    delayCnt = 0;
-    recBufLen = 11;
-    targetDataBit = 7;
-    while (result == false)
-    {
-      result = findPacket(header1, headerLen, recBuf, recBufLen);
-      delay(50);
-      delayCnt++;
-      if (delayCnt > 10)
-      {
-        _isAutoMode = false;
-        break;
-      }
-    }
+    yield(); // Keeps polling loops cooperative
+    return (_lastStatus & 0x01) == 0x01; // Tracked from the packets as they arrive
   }
+  return (readCommand(0x0c) & 0x01) == 0x01;
+}
 
-  if (result == true)
+/**********************************************************
+Description: Get the oldest STATUS pin edge
+Parameters: event: Receives the edge direction and timestamps
+Return:   1: Event read
+          0: No event recorded
+Others: Requires begin(statusPin)
+**********************************************************/
+bool BM22S402x_1::readStatusEvent(BM22S402x_1_StatusEvent &event)
+{
+  uint8_t tail = _eventTail;
+  if (_statusIrqSlot < 0)
   {
-    if ((recBuf[targetDataBit] & 0x01) == 0x01)
-    {
-      return true;
-    }
-    else
-    {
-      return false;
-    }
+    pollStatusPin();
   }
-  else
+  if (tail == _eventHead)
   {
     return false;
   }
+  event.isTrigger = _events[tail].isTrigger;
+  event.timeMs = _events[tail].timeMs;
+  event.timeUs = _events[tail].timeUs;
+  _eventTail = (tail + 1) & (BM22S402x_1_EVENT_QUEUE_SIZE - 1);
+  return true;
+}
+
+/**********************************************************
+Description: Get the number of STATUS pin edges lost because the queue was full
+Parameters: None
+Return: Drop counter
+Others: None
+**********************************************************/
+uint16_t BM22S402x_1::getStatusEventDropCount()
+{
+  return _eventDropCount;
+}
+
+/**********************************************************
+Description: Get the number of information packets that disagreed with the STATUS pin
+Parameters: None
+Return: Mismatch counter
+Others: Cross-check between the STATUS pin and the trigger bit
+        of AUTO mode packets; a few counts around edges are normal.
+**********************************************************/
+uint16_t BM22S402x_1::getStatusMismatchCount()
+{
+  return _statusMismatchCount;
 }
 
 /**********************************************************
@@ -236,21 +423,18 @@ Description: Query whether the data package automatically output by the module i
 Parameters: None
 Return:   1: Received
           0: Not received
-Others: None
+Others: Never blocks. Returns 1 once for each new packet
+        assembled since the previous call.
 **********************************************************/
 bool BM22S402x_1::isInfoAvailable()
 {
-  bool result = false;
-  uint8_t header[3] = {0xfb, 0x55, 0x07};
-  result = findPacket(header, 3, _infoPacket, 11);
-  if (result == false)
+  update();
+  if (_infoFresh)
   {
-    for (uint8_t i = 0; i < 11; i++)
-    {
-      _infoPacket[i] = 0;
-    }
+    _infoFresh = false;
+    return true;
   }
-  return result;
+  return false;
 }
 
 /**********************************************************
@@ -270,6 +454,89 @@ void BM22S402x_1::readInfopacket(uint8_t dataBuf[])
   }
 }
 
+/**********************************************************
+Description: Get the last continuous output information packet in place
+Parameters: None
+Return: Pointer to the 7 data bytes, same layout as readInfopacket()
+Others: The data stays valid until the next packet completes,
+        i.e. until the next update()/isInfoAvailable() call.
+**********************************************************/
+const uint8_t *BM22S402x_1::getInfoPacket()
+{
+  return _infoPacket + 3;
+}
+
+/**********************************************************
+Description: Decode the last continuous output information packet
+Parameters: sample: Receives PIR values, status, temperature and arrival time
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1::getInfoSample(BM22S402x_1_Sample &sample)
+{
+  sample.rawPIR = ((uint16_t)_infoPacket[4] << 8) | _infoPacket[3];
+  sample.PIR = ((uint16_t)_infoPacket[6] << 8) | _infoPacket[5];
+  sample.status = _infoPacket[7];
+  sample.temperature = (int16_t)(((uint16_t)_infoPacket[9] << 8) | _infoPacket[8]);
+  sample.timeMs = _infoTimeMs;
+  sample.timeUs = _infoTimeUs;
+}
+
+/**********************************************************
+Description: Get the temperature of the last information packet
+Parameters: isFahrenheit: false: Return Centigrade
+                          true: Return Fahrenheit
+Return: Temperature in 0.1 degree units, e.g. 253 = 25.3
+Others: Integer only, no float code is linked
+**********************************************************/
+int16_t BM22S402x_1::getInfoTemperature(bool isFahrenheit)
+{
+  int16_t deciCelsius = (int16_t)(((uint16_t)_infoPacket[9] << 8) | _infoPacket[8]);
+  return isFahrenheit ? toFahrenheitDeci(deciCelsius) : deciCelsius;
+}
+
+/**********************************************************
+Description: Record every received information packet into a history buffer
+Parameters: history: BM22S402x_1_History<N> object, NULL to detach
+Return: None
+Others: Packets are stored from update(), so a slow consumer
+        can drain them later with history.read()
+**********************************************************/
+void BM22S402x_1::attachHistory(BM22S402x_1_SampleBuffer *history)
+{
+  _history = history;
+}
+
+/**********************************************************
+Description: Run every received information packet through a processor
+Parameters: processor: BM22S402x_1_SignalProcessor<N> object, NULL to detach
+Return: None
+Others: Packets are processed from update(); read the result
+        with processor.isTriggered() and processor.getValue()
+**********************************************************/
+void BM22S402x_1::attachProcessor(BM22S402x_1_Processor *processor)
+{
+  _processor = processor;
+}
+
+/**********************************************************
+Description: Aggregate the trigger state into occupancy statistics
+Parameters: occupancy: BM22S402x_1_OccupancyTracker<N> object, NULL to detach
+Return: None
+Others: Restarts the aggregation. Triggers and releases are recorded
+        as the driver reports them(AUTO mode packets, 0x0C replies
+        or the STATUS pin); query the occupancy object at any time.
+**********************************************************/
+void BM22S402x_1::attachOccupancy(BM22S402x_1_Occupancy *occupancy)
+{
+  _occupancy = occupancy;
+  if (_occupancy != NULL)
+  {
+    _occupancy->reset();
+    _occupancy->record(_notifiedTrigger, millis());
+  }
+}
+
 /**********************************************************
 Description: Read Filtered PIR value
 Parameters: None
@@ -278,16 +545,7 @@ Others: None
 **********************************************************/
 uint16_t BM22S402x_1::readPIR()
 {
-  uint16_t PIRVlaue = 0;
-  uint8_t sendBuf[4] = {0xfb, 0x02, 0x00, 0x02};
-  uint8_t recBuf[6], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 6);
-  if (errFlag == READ_OK && 0x02 == recBuf[1])
-  {
-    PIRVlaue = ((uint16_t)recBuf[4] << 8) + recBuf[3];
-  }
-  return PIRVlaue;
+  return read<Cmd::FilteredPIR>();
 }
 
 /**********************************************************
@@ -298,94 +556,188 @@ Others: None
 **********************************************************/
 uint16_t BM22S402x_1::readRawPIR()
 {
-  int16_t rawVlaue = 0;
-  uint8_t sendBuf[4] = {0xfb, 0x01, 0x00, 0x01};
-  uint8_t recBuf[6], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 6);
-  if (errFlag == READ_OK && 0x01 == recBuf[1])
-  {
-    rawVlaue = (int16_t)((uint16_t)recBuf[4] << 8 | recBuf[3]);
-  }
-  return rawVlaue;
+  return read<Cmd::RawPIR>();
 }
 
 /**********************************************************
 Description: Read Temperature
 Parameters:   0: Return Centigrade
               1: Return fahrenheit
-Return: Temperature(unit: Centigrade or Fahrenheit)
-Others: None
+Return: Temperature in 0.1 degree units(e.g. 253 = 25.3), 0 on error
+Others: Integer only, readTemperature() is the float wrapper
+**********************************************************/
+int16_t BM22S402x_1::readTemperatureDeci(bool isFahrenheit)
+{
+  int16_t tmp = read<Cmd::Temperature>();
+  if (_cmdStatus != READ_OK)
+  {
+    return 0;
+  }
+  return isFahrenheit ? toFahrenheitDeci(tmp) : tmp;
+}
+
+/**********************************************************
+Description: Convert 0.1 Centigrade to 0.1 Fahrenheit
+Parameters: deciCelsius: Temperature in 0.1 Centigrade
+Return: Temperature in 0.1 Fahrenheit, rounded to nearest
+Others: F = 32 + C * 1.8, computed as 320 + dC * 9 / 5
+**********************************************************/
+int16_t BM22S402x_1::toFahrenheitDeci(int16_t deciCelsius)
+{
+  int32_t scaled = (int32_t)deciCelsius * 9;
+  scaled += (scaled < 0) ? -2 : 2; // Round half away from zero
+  return (int16_t)(320 + scaled / 5);
+}
+
+/**********************************************************
+Description: Read the module configuration
+Parameters: config: Receives PIR control, sensitivity, delay time and block time
+Return:   0: Read ok
+          1: Check error
+          2: Timeout error
+          3: CMD error
+Others: Only registers missing from the cache are read,
+        and those reads are pipelined.
 **********************************************************/
-float BM22S402x_1::readTemperature(bool isFahrenheit)
+uint8_t BM22S402x_1::readConfig(BM22S402x_1_Config &config)
 {
-  float tempValue = 0;
-  uint16_t tmp = 0;
-  uint8_t sendBuf[4] = {0xfb, 0x10, 0x00, 0x10};
-  uint8_t recBuf[6], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 6);
-  if (errFlag == READ_OK && 0x10 == recBuf[1])
+  uint8_t i;
+  waitForReply();
+  for (i = 0; i < 4; i++)
+  {
+    _trackStatus[i] = READ_OK;
+    if ((_cacheValid & (1 << i)) == 0)
+    {
+      _trackStatus[i] = BUSY;
+      enqueue(0x04 + 2 * i, REQ_TRACK, 0);
+    }
+  }
+  waitForReply();
+  for (i = 0; i < 4; i++)
   {
-    tmp = (uint16_t)recBuf[4] << 8 | recBuf[3];
-    tempValue = tmp * 0.1;
-    if (isFahrenheit)
+    if (_trackStatus[i] != READ_OK)
     {
-      tempValue = 32 + tempValue * 1.8;
+      return _trackStatus[i];
     }
   }
-  return tempValue;
+  config.PIRControl = _cache[0];
+  config.sensitivity = _cache[1];
+  config.delayTime = _cache[2];
+  config.blockTime = _cache[3];
+  return READ_OK;
 }
 
 /**********************************************************
-Description: Write parameter to module register
-Parameters: 8-bit or 16-bit data
+Description: Apply a module configuration, writing only what changed
+Parameters: config: Wanted configuration
+            failedMask: Receives a bit per register that could not be written,
+                        bit0~bit3: PIR control, sensitivity, delay time, block time;
+                        bit4~bit7: the same registers, written but not restored
+                        because their rollback write failed
+            rollback: 1: Restore registers already written if another write fails
+                      0: Leave successful writes in place
 Return:   0: Write ok
           1: Check error
           2: Timeout error
           3: CMD error
           4: Setting failed
-Others: None
+Others: Current values come from the cache or one pipelined read.
+        The differing registers are written back-to-back and each
+        echo is verified, rollback writes included; the first error
+        is returned.
 **********************************************************/
-uint8_t BM22S402x_1::writeCommand(uint8_t cmd, uint16_t param)
+uint8_t BM22S402x_1::applyConfig(const BM22S402x_1_Config &config, uint8_t *failedMask, bool rollback)
 {
-  uint8_t paramH = param >> 8, paramL = param, dataLen = 1;
-  uint8_t sendBuf[6] = {0xfb, cmd, 0x01, paramL, 0x00, 0x00};
-  uint8_t recBuf[6], errFlag;
-  if (cmd == 0x09)
+  BM22S402x_1_Config current;
+  uint16_t target[4] = {config.PIRControl, config.sensitivity, config.delayTime, config.blockTime};
+  uint16_t previous[4];
+  uint8_t i, changed = 0, failed = 0, errFlag;
+
+  errFlag = readConfig(current);
+  if (errFlag != READ_OK)
   {
-    sendBuf[2] = 0x02;
-    sendBuf[4] = paramH;
-    sendBuf[5] = sendBuf[1] + sendBuf[2] + sendBuf[3] + sendBuf[4];
-    dataLen = 2;
+    if (failedMask != NULL)
+    {
+      *failedMask = 0x0f;
+    }
+    return errFlag;
   }
-  else
+  previous[0] = current.PIRControl;
+  previous[1] = current.sensitivity;
+  previous[2] = current.delayTime;
+  previous[3] = current.blockTime;
+
+  for (i = 0; i < 4; i++)
   {
-    sendBuf[4] = sendBuf[1] + sendBuf[2] + sendBuf[3];
+    if (target[i] != previous[i])
+    {
+      changed |= (1 << i);
+      _trackStatus[i] = BUSY; // Stays BUSY if the queue is full
+      enqueue(0x05 + 2 * i, REQ_WRITE | REQ_TRACK, target[i]);
+    }
+  }
+  waitForReply();
+  for (i = 0; i < 4; i++)
+  {
+    if ((changed & (1 << i)) && _trackStatus[i] != WRITE_OK)
+    {
+      failed |= (1 << i);
+      if (errFlag == WRITE_OK)
+      {
+        errFlag = _trackStatus[i];
+      }
+    }
   }
-  writeBytes(sendBuf, dataLen + 4);
-  errFlag = readBytes(recBuf, dataLen + 4);
-  if (errFlag == READ_OK && cmd == recBuf[1])
+
+  /* Partial failure: put back the registers that did change */
+  if (failed != 0 && rollback)
   {
-    if (dataLen == 1)
+    for (i = 0; i < 4; i++)
     {
-      if (paramL != recBuf[3])
+      if ((changed & ~failed) & (1 << i))
       {
-        errFlag = WRITE_FAILED;
+        _trackStatus[i] = BUSY;
+        enqueue(0x05 + 2 * i, REQ_WRITE | REQ_TRACK, previous[i]);
       }
     }
-    else
+    waitForReply();
+    for (i = 0; i < 4; i++)
     {
-      if ((paramL != recBuf[3]) || (paramH != recBuf[4]))
+      if (((changed & ~failed) & (1 << i)) && _trackStatus[i] != WRITE_OK)
       {
-        errFlag = WRITE_FAILED;
+        failed |= (0x10 << i); // Register keeps the new value
       }
     }
   }
-  delay(10); // Communication interval delay
+  if (failedMask != NULL)
+  {
+    *failedMask = failed;
+  }
   return errFlag;
 }
 
+/**********************************************************
+Description: Write parameter to module register
+Parameters: 8-bit or 16-bit data
+Return:   0: Write ok
+          1: Check error
+          2: Timeout error
+          3: CMD error
+          4: Setting failed
+Others: Skips the UART when the cached register already holds param
+**********************************************************/
+uint8_t BM22S402x_1::writeCommand(uint8_t cmd, uint16_t param)
+{
+  uint16_t cached;
+  waitForReply();
+  if (getCachedRegister(cmd, cached) && cached == param)
+  {
+    return WRITE_OK; // Register already holds this value
+  }
+  submitCommand(cmd, param);
+  return waitForReply();
+}
+
 /**********************************************************
 Description: Enable PIR detection
 Parameters:   1: Enable PIR
@@ -395,19 +747,26 @@ Return:   0: Write ok
           2: Timeout error
           3: CMD error
           4: Setting failed
-Others: None
+Others: Uses the cached PIR control register when it is known
 **********************************************************/
 uint8_t BM22S402x_1::enablePIR(bool isEnable)
 {
-  uint8_t PIRReg;
-  PIRReg = readCommand(0x04);
+  uint16_t PIRReg;
+  if (getCachedRegister(0x04, PIRReg) == false)
+  {
+    PIRReg = readCommand(0x04);
+    if (_cmdStatus != READ_OK)
+    {
+      return _cmdStatus;
+    }
+  }
   if (isEnable)
   {
     PIRReg |= 0x08;
   }
   else
   {
-    PIRReg |= 0x00;
+    PIRReg &= ~0x08;
   }
   return writeCommand(0x05, PIRReg);
 }
@@ -424,14 +783,17 @@ Others: After receiving this command,
 **********************************************************/
 uint8_t BM22S402x_1::reset()
 {
-  uint8_t sendBuf[4] = {0xfb, 0x0f, 0x00, 0x0f};
-  uint8_t recBuf[4], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 4);
-  delay(10); // Communication interval delay
-  if (errFlag == READ_OK && recBuf[1] == 0x0f)
+  uint8_t errFlag;
+  waitForReply();
+  submitCommand(0x0f);
+  errFlag = waitForReply();
+  if (errFlag == READ_OK)
   {
-    delay(1000); // Wait for the module reset to complete
+    /* Wait for the module reset to complete (guard time set by the engine) */
+    while ((uint32_t)(millis() - _guardStart) < _guardTime)
+    {
+      yield();
+    }
   }
   return errFlag;
 }
@@ -444,11 +806,12 @@ Return:   0: Reset ok
           2: Timeout error
           3: CMD error
           4: Setting failed
-Others:
+Others: Invalidates the register cache; both registers are rewritten
 **********************************************************/
 uint8_t BM22S402x_1::restoreDefault()
 {
   uint8_t errFlag;
+  invalidateCache();
   errFlag = writeCommand(0x05, 0x6b);
   if (errFlag == 0)
   {
@@ -472,302 +835,1107 @@ Others: Master transmits 1-byte command to sensor and get into sleep.
 **********************************************************/
 uint8_t BM22S402x_1::sleep()
 {
-  uint8_t sendBuf[4] = {0xfb, 0x0d, 0x00, 0x0d};
-  uint8_t recBuf[4], errFlag;
-  writeBytes(sendBuf, 4);
-  errFlag = readBytes(recBuf, 4);
-  delay(10); // Communication interval delay
+  uint8_t errFlag;
+  waitForReply();
+  submitCommand(0x0d);
+  errFlag = waitForReply();
   if (errFlag == READ_OK)
   {
-    delay(100); // Wait for the module to sleep
+    /* Wait for the module to sleep (guard time set by the engine) */
+    while ((uint32_t)(millis() - _guardStart) < _guardTime)
+    {
+      yield();
+    }
   }
   return errFlag;
 }
 
-/*-------------------------------------  Private  -------------------------------------*/
 /**********************************************************
-Description: clear UART FIFO
-Parameters:  none
-Return:      none
-Others:      none
+Description: Submit a read-type command without waiting for the reply
+Parameters:  cmd: Command code
+Return:   1: Command queued
+          0: Queue full, command rejected
+Others: Call update() from loop() to advance the transaction;
+        the result is reported by getCommandStatus()/getCommandResult()
+        and by the handler registered with onReply().
+        Queued commands are sent back-to-back in submission order.
 **********************************************************/
-void BM22S402x_1::clear_UART_FIFO()
+bool BM22S402x_1::submitCommand(uint8_t cmd)
+{
+  return enqueue(cmd, 0, 0);
+}
+
+/**********************************************************
+Description: Submit a write command without waiting for the reply
+Parameters:  cmd: Command code for writing registers
+             param: 8-bit or 16-bit data
+Return:   1: Command queued
+          0: Queue full, command rejected
+Others: The module echoes the written value; a mismatch
+        completes the transaction with WRITE_FAILED.
+**********************************************************/
+bool BM22S402x_1::submitCommand(uint8_t cmd, uint16_t param)
+{
+  return enqueue(cmd, REQ_WRITE, param);
+}
+
+/**********************************************************
+Description: Advance the transaction engine
+Parameters: None
+Return: None
+Others: Never blocks. Sends a pending request once the
+        communication interval has elapsed, consumes reply
+        bytes as they arrive and detects reply timeouts.
+        While no reply is expected, received bytes are fed
+        to the AUTO mode information packet framer.
+**********************************************************/
+void BM22S402x_1::update()
 {
-  if (_softSerial != NULL)
+  uint16_t budget = BM22S402x_1_MAX_BYTES_PER_UPDATE;
+  bool wasUpdating = _isUpdating;
+  _isUpdating = true;
+  if (_statusPin != 0xff)
   {
-    while (_softSerial->available() > 0)
+    if (_statusIrqSlot < 0)
     {
-      _softSerial->read();
+      pollStatusPin();
     }
-  }
-  else
-  {
-    while (_hardSerial->available() > 0)
+    if (_statusLevel != _notifiedTrigger)
     {
-      _hardSerial->read();
+      dispatchTrigger(_statusLevel);
     }
   }
+  receiveFrames(budget);
+  if (_state == STATE_PENDING && (uint32_t)(millis() - _guardStart) >= _guardTime)
+  {
+    sendRequest(); // Next queued command goes out as soon as the previous one completes
+    receiveFrames(budget);
+  }
+  _isUpdating = wasUpdating;
 }
 
 /**********************************************************
-Description: Write data through UART
-Parameters: wbuf:The array for storing Data to be sent
-            wlen:Length of data sent
+Description: Query whether a command is still in progress
+Parameters: None
+Return:   1: Commands queued or waiting for the reply
+          0: Engine idle
+Others: None
+**********************************************************/
+bool BM22S402x_1::isBusy()
+{
+  return _state != STATE_IDLE;
+}
+
+/**********************************************************
+Description: Get the status of the last submitted command
+Parameters: None
+Return:   0: Read/Write ok
+          1: Check error
+          2: Timeout error
+          3: CMD error
+          4: Setting failed
+          5: Busy
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1::getCommandStatus()
+{
+  return _cmdStatus;
+}
+
+/**********************************************************
+Description: Get the value replied to the last completed command
+Parameters: None
+Return: 8-bit or 16-bit parameter
+Others: Only meaningful when getCommandStatus() returns 0
+**********************************************************/
+uint16_t BM22S402x_1::getCommandResult()
+{
+  return _cmdResult;
+}
+
+/**********************************************************
+Description: Register the command completion handler
+Parameters: handler: Called with (cmd, status, value) when a command completes,
+                     NULL to remove
+Return: None
+Others: The handler runs from update(), never from an interrupt.
+        It may submit commands; they are sent by update().
+**********************************************************/
+void BM22S402x_1::onReply(BM22S402x_1_ReplyHandler handler)
+{
+  _replyHandler = handler;
+}
+
+/**********************************************************
+Description: Set the resend policy for failed commands
+Parameters: retries: Resends after a check or timeout error, 0 disables(default 2)
+            backoffMs: Wait before the first resend, doubled for each
+                       further resend(default 10)
+Return: None
+Others: Command errors and failed settings are not resent
+**********************************************************/
+void BM22S402x_1::setRetryPolicy(uint8_t retries, uint16_t backoffMs)
+{
+  _retryLimit = retries;
+  _retryBackoff = backoffMs;
+}
+
+/**********************************************************
+Description: Set how long the module may take to answer
+Parameters: marginMs: Wait on top of the frame transfer time(default 20)
+Return: None
+Others: The reply timeout is the margin plus the time the request and
+        the longest reply of the command take at BM22S402x_1_BAUD
+**********************************************************/
+void BM22S402x_1::setReplyMargin(uint16_t marginMs)
+{
+  _replyMargin = marginMs;
+}
+
+/**********************************************************
+Description: Keep AUTO mode data received before a command
+Parameters: isPreserve: true: Bytes waiting in the UART FIFO go to the
+                              frame receiver(default)
+                        false: Bytes are discarded
 Return: None
 Others: None
 **********************************************************/
-void BM22S402x_1::writeBytes(uint8_t wbuf[], uint8_t wlen)
+void BM22S402x_1::setPreserveStream(bool isPreserve)
+{
+  _preserveStream = isPreserve;
+}
+
+/**********************************************************
+Description: Register the trigger handler
+Parameters: handler: Called with millis() when the module becomes triggered,
+                     NULL to remove
+Return: None
+Others: The state comes from the STATUS pin with begin(statusPin),
+        otherwise from AUTO mode packets and 0x0C replies.
+        Handlers run from update(), never from an interrupt;
+        do not call blocking functions from a handler.
+**********************************************************/
+void BM22S402x_1::onTrigger(BM22S402x_1_EventHandler handler)
+{
+  _triggerHandler = handler;
+}
+
+/**********************************************************
+Description: Register the release handler
+Parameters: handler: Called with millis() when the trigger ends,
+                     NULL to remove
+Return: None
+Others: Same source as onTrigger()
+**********************************************************/
+void BM22S402x_1::onRelease(BM22S402x_1_EventHandler handler)
+{
+  _releaseHandler = handler;
+}
+
+/**********************************************************
+Description: Register the stable handler
+Parameters: handler: Called with millis() when the module reports
+                     it is stable, NULL to remove
+Return: None
+Others: Called again if the module is reset and warms up again
+**********************************************************/
+void BM22S402x_1::onStable(BM22S402x_1_EventHandler handler)
+{
+  _stableHandler = handler;
+}
+
+/**********************************************************
+Description: Register the information packet handler
+Parameters: handler: Called with every decoded AUTO mode packet,
+                     NULL to remove
+Return: None
+Others: The handler runs from update() and may submit commands
+**********************************************************/
+void BM22S402x_1::onPacket(BM22S402x_1_PacketHandler handler)
 {
-  clear_UART_FIFO();
+  _packetHandler = handler;
+}
 
-  /*Select hardSerial or softSerial according to the setting*/
-  if (_softSerial != NULL)
+/**********************************************************
+Description: Register the command error handler
+Parameters: handler: Called with (cmd, status) when a command fails,
+                     NULL to remove
+Return: None
+Others: Called before the onReply() handler
+**********************************************************/
+void BM22S402x_1::onError(BM22S402x_1_ErrorHandler handler)
+{
+  _errorHandler = handler;
+}
+
+/**********************************************************
+Description: Get a register value from the shadow register cache
+Parameters: cmd: Read or write command code of the register(0x04~0x0B)
+            value: Receives the cached value
+Return:   1: Cached value is valid
+          0: Register not cached, read it with readCommand()
+Others: The cache is filled by successful reads and echo-confirmed
+        writes, and cleared by reset(), sleep() and restoreDefault().
+**********************************************************/
+bool BM22S402x_1::getCachedRegister(uint8_t cmd, uint16_t &value)
+{
+  int8_t index = cacheIndex(cmd);
+  if (index < 0 || (_cacheValid & (1 << index)) == 0)
   {
-    _softSerial->write(wbuf, wlen);
+    return false;
   }
-  if (_hardSerial != NULL)
+  value = _cache[index];
+  return true;
+}
+
+/**********************************************************
+Description: Forget all cached register values
+Parameters: None
+Return: None
+Others: Call this if the module may have been changed by other means
+**********************************************************/
+void BM22S402x_1::invalidateCache()
+{
+  _cacheValid = 0;
+}
+
+#if BM22S402x_1_STATS
+/**********************************************************
+Description: Get the UART link statistics
+Parameters: None
+Return: Counters and per-command latency since the last resetStats()
+Others: Only available when BM22S402x_1_STATS is 1
+**********************************************************/
+const BM22S402x_1_Stats &BM22S402x_1::getStats()
+{
+  return _stats;
+}
+
+/**********************************************************
+Description: Clear the UART link statistics
+Parameters: None
+Return: None
+Others: Only available when BM22S402x_1_STATS is 1
+**********************************************************/
+void BM22S402x_1::resetStats()
+{
+  memset(&_stats, 0, sizeof(_stats));
+  for (uint8_t i = 0; i < BM22S402x_1_CMD_COUNT; i++)
   {
-    _hardSerial->write(wbuf, wlen);
+    _stats.latency[i].minUs = 0xffff;
   }
-  delay(10); // Wait for the module to reply data
 }
+#endif
 
+/*-------------------------------------  Private  -------------------------------------*/
 /**********************************************************
-Description: Read data through UART
-Parameters: rbuf: Used to store received data
-            rlen: Length of data to be read
-Return:   0: Read ok
-          1: Check error
-          2: Timeout error
-          3: CMD error
-Others: None
+Description: Append a command to the transaction queue
+Parameters:  cmd: Command code
+             flags: REQ_WRITE, REQ_SNAPSHOT
+             param: Data written by a write command
+Return:      1: Command queued
+             0: Queue full
+Others:      none
 **********************************************************/
-uint8_t BM22S402x_1::readBytes(uint8_t rbuf[], uint8_t rlen, uint16_t timeout)
+bool BM22S402x_1::enqueue(uint8_t cmd, uint8_t flags, uint16_t param)
 {
-  uint8_t i = 0, delayCnt = 0, checkSum = 0;
-  uint8_t recBuf[15] = {0};
-  /* Select SoftwareSerial Interface */
-  if (_softSerial != NULL)
+  uint8_t tail;
+  if (_queueCount >= BM22S402x_1_QUEUE_SIZE)
+  {
+    return false;
+  }
+  tail = (_queueHead + _queueCount) % BM22S402x_1_QUEUE_SIZE;
+  _queue[tail].cmd = cmd;
+  _queue[tail].flags = flags;
+  _queue[tail].param = param;
+  _queueCount++;
+  if (_state == STATE_IDLE)
   {
-    for (i = 0; i < rlen; i++)
+    _state = STATE_PENDING;
+    _cmdStatus = BUSY;
+    if (!_isUpdating)
     {
-      delayCnt = 0;
-      while (_softSerial->available() == 0)
-      {
-        if (delayCnt > timeout)
-        {
-          return TIMEOUT_ERROR; // Timeout error
-        }
-        delay(1);
-        delayCnt++;
-      }
-      recBuf[i] = _softSerial->read();
+      update(); // From a handler the running update() sends it
     }
   }
-  /* Select HardwareSerial Interface */
-  else
+  return true;
+}
+
+/**********************************************************
+Description: Build and send the request frame at the head of the queue
+Parameters:  none
+Return:      none
+Others:      The frame is built from the lengths in cmdTable: a read
+             frame is 0xFB cmd 0x00 cmd and a write frame carries the
+             submitted value, so stored frames would only save the
+             checksum additions.
+             A request refused by a shared line for LINE_TIMEOUT
+             completes with TIMEOUT_ERROR, e.g. while the sketch
+             waits on one module and another holds the line
+**********************************************************/
+void BM22S402x_1::sendRequest()
+{
+  Request &req = _queue[_queueHead];
+  uint8_t len = 0;
+  _reqCmd = req.cmd;
+  _reqFlags = req.flags;
+  _reqParam = req.param;
+  if (!_transport->acquire())
   {
-    for (i = 0; i < rlen; i++)
+    if (!_isWaitingLine)
     {
-      delayCnt = 0;
-      while (_hardSerial->available() == 0)
-      {
-        if (delayCnt > timeout)
-        {
-          return TIMEOUT_ERROR; // Timeout error
-        }
-        delay(1);
-        delayCnt++;
-      }
-      recBuf[i] = _hardSerial->read();
+      _isWaitingLine = true;
+      _lineWaitStart = millis();
     }
+    else if ((uint32_t)(millis() - _lineWaitStart) >= BM22S402x_1_LINE_TIMEOUT)
+    {
+      _isWaitingLine = false;
+      finishRequest(TIMEOUT_ERROR);
+    }
+    return; // Line in use by another module, stays pending
+  }
+  _isWaitingLine = false;
+  if (req.flags & REQ_WRITE)
+  {
+    len = getRequestLen(req.cmd);
   }
-  /* Check whether the command is incorrect */
-  if (recBuf[0] == 0xFB && recBuf[1] == 0xAB && recBuf[2] == 0x00 && recBuf[3] == 0xAB)
+  _txBuf[0] = 0xfb;
+  _txBuf[1] = req.cmd;
+  _txBuf[2] = len;
+  _txBuf[3] = req.param;      // Low byte, overwritten by the checksum if len = 0
+  _txBuf[4] = req.param >> 8; // High byte, overwritten by the checksum if len = 1
+  _txBuf[len + 3] = req.cmd + len + (len > 0 ? _txBuf[3] : 0) + (len > 1 ? _txBuf[4] : 0);
+  _txLen = len + 4;
+  if (!_preserveStream)
   {
-    return CMD_ERROR;
+    clear_UART_FIFO();
+    _frameLen = 0;
   }
+  writeBytes(_txBuf, _txLen);
+  _sendTime = millis();
+  /* Transfer time of the request and the longest reply at 10 bits per byte, plus the margin */
+  _replyTimeout = _replyMargin + ((uint32_t)(_txLen + getReplyLen(req.cmd) + 4) * 10000 + BM22S402x_1_BAUD - 1) / BM22S402x_1_BAUD;
+#if BM22S402x_1_STATS
+  _sendTimeUs = micros();
+#endif
+  _state = STATE_WAIT_REPLY;
+}
 
-  /* check Sum */
-  for (i = 1; i < (rlen - 1); i++)
+/**********************************************************
+Description: Resend the current request or complete it with an error
+Parameters:  status: CHECK_ERROR or TIMEOUT_ERROR
+Return:      none
+Others:      Resends wait RETRY_BACKOFF, doubled for each further resend
+**********************************************************/
+void BM22S402x_1::failRequest(uint8_t status)
+{
+  if (_reqAttempt >= _retryLimit)
   {
-    checkSum += recBuf[i];
+    finishRequest(status);
+    return;
   }
-  if (checkSum == recBuf[rlen - 1])
+  STATS_ADD(retries, 1);
+  _transport->release(); // Other modules may use a shared line during the backoff
+  _guardStart = millis();
+  _guardTime = _retryBackoff << _reqAttempt;
+  _reqAttempt++;
+  _state = STATE_PENDING; // Request stays at the queue head
+}
+
+/**********************************************************
+Description: Complete the current transaction
+Parameters:  status: Transaction status
+Return:      none
+Others:      Sets the communication interval before the next request
+**********************************************************/
+void BM22S402x_1::finishRequest(uint8_t status)
+{
+  uint16_t value = 0;
+  if (status == READ_OK)
   {
-    for (i = 0; i < rlen; i++)
+    if (_rxBuf[2] >= 2)
+    {
+      value = ((uint16_t)_rxBuf[4] << 8) | _rxBuf[3];
+    }
+    else if (_rxBuf[2] == 1)
+    {
+      value = _rxBuf[3];
+    }
+    if ((_reqFlags & REQ_WRITE) && value != _reqParam)
     {
-      rbuf[i] = recBuf[i];
+      status = WRITE_FAILED;
     }
-    return READ_OK; // Check correct
   }
-  else
+#if BM22S402x_1_STATS
+  switch (status)
   {
-    return CHECK_ERROR; // Check error
+  case TIMEOUT_ERROR:
+    _stats.timeouts++;
+    break;
+  case CMD_ERROR:
+    _stats.cmdErrors++;
+    break;
+  case CHECK_ERROR: // Counted as checksumErrors per attempt
+    break;
+  case WRITE_FAILED:
+    _stats.writeFailures++;
+    recordLatency(micros() - _sendTimeUs);
+    break;
+  default:
+    _stats.framesOK++;
+    recordLatency(micros() - _sendTimeUs);
+    break;
+  }
+#endif
+  _cmdStatus = status;
+  _cmdResult = value;
+  _reqAttempt = 0;
+  _queueHead = (_queueHead + 1) % BM22S402x_1_QUEUE_SIZE;
+  _queueCount--;
+  _state = (_queueCount > 0) ? STATE_PENDING : STATE_IDLE;
+  _transport->release();
+  if (_reqFlags & REQ_SNAPSHOT)
+  {
+    storeSnapshot(status, value);
+  }
+  updateCache(status, value);
+  if ((_reqFlags & REQ_TRACK) && cacheIndex(_reqCmd) >= 0)
+  {
+    _trackStatus[cacheIndex(_reqCmd)] = status;
+  }
+
+  _guardStart = millis();
+  switch (_reqCmd)
+  {
+  case 0x0d:
+    _guardTime = BM22S402x_1_CMD_INTERVAL + (status == READ_OK ? 100 : 0); // Wait for the module to sleep
+    break;
+  case 0x0f:
+    _guardTime = BM22S402x_1_CMD_INTERVAL + (status == READ_OK ? 1000 : 0); // Wait for the module reset to complete
+    if (status == READ_OK)
+    {
+      startWarmup(_guardStart + _guardTime); // Module restarts when the reset completes
+    }
+    break;
+  default:
+    /* Reads are pipelined, module needs the interval only after a write */
+    _guardTime = (_reqFlags & REQ_WRITE) ? BM22S402x_1_CMD_INTERVAL : 0;
+    break;
+  }
+
+  if (_reqCmd == 0x0c && status == READ_OK)
+  {
+    dispatchStatus(value);
+  }
+  if (_group != NULL)
+  {
+    _group->onReply(_groupIndex, _reqCmd, status, value);
+  }
+  if (_power != NULL)
+  {
+    _power->onReply(status, value);
+  }
+  if (status != READ_OK && _errorHandler != NULL)
+  {
+    _errorHandler(_reqCmd, status);
+  }
+  if (_replyHandler != NULL)
+  {
+    _replyHandler(_reqCmd, status, value);
   }
 }
 
 /**********************************************************
-Description: Find packet with specified header
-Parameters: header[]: Packet header
-            headerLen: Packet header length
-            packet[]: Store found packet
-            packetLen: Packet length
-            num: Number of executions
-Return:   0: Target packet not found
-          1: Target packet found
-Others: See Datasheet for the meaning of each byte
+Description: Get the shadow register slot of a command
+Parameters:  cmd: Command code
+Return:      0~3: PIR control, sensitivity, delay time, block time
+             -1: Register not cached
+Others:      Read command 2n and write command 2n+1 share a slot
 **********************************************************/
-bool BM22S402x_1::findPacket(uint8_t header[], uint8_t headerLen, uint8_t packet[], uint8_t packetLen)
+int8_t BM22S402x_1::cacheIndex(uint8_t cmd)
 {
-  bool isHeader = false, result = false;
-  uint8_t cnt = 0, i;
-  uint8_t recBuf[11] = {0}, checkSum = 0, failCnt = 0, readCnt = 0;
-  /* Select hardSerial or softSerial according to the setting */
-  if (_softSerial != NULL)
+  if (cmd < 0x04 || cmd > 0x0b)
   {
-    cnt = _softSerial->available();
+    return -1;
   }
-  else if (_hardSerial != NULL)
+  return (cmd - 0x04) >> 1;
+}
+
+/**********************************************************
+Description: Keep the shadow registers in step with a completed command
+Parameters:  status: Transaction status
+             value: Value read or echoed
+Return:      none
+Others:      A failed write leaves the register state unknown
+**********************************************************/
+void BM22S402x_1::updateCache(uint8_t status, uint16_t value)
+{
+  int8_t index = cacheIndex(_reqCmd);
+  if (_reqCmd == 0x0d || _reqCmd == 0x0f)
   {
-    cnt = _hardSerial->available();
+    _cacheValid = 0; // Sleep or reset
   }
-  if (cnt >= packetLen)
+  else if (index >= 0)
   {
-    while (failCnt < 6)
+    if (status == READ_OK)
     {
-      /* Find header string */
-      for (i = 0; i < headerLen;)
-      {
-        if (_softSerial != NULL)
-        {
-          recBuf[i] = _softSerial->read();
-        }
-        else if (_hardSerial != NULL)
-        {
-          recBuf[i] = _hardSerial->read();
-        }
-        if (recBuf[i] == header[i])
-        {
-          isHeader = true; // Fixed code is correct
-          i++;             // Next byte
-        }
-        else if ((recBuf[i] != header[i]) && (i > 0))
-        {
-          isHeader = false; // Next fixed code error
-          failCnt++;
-          break;
-        }
-        else if ((recBuf[i] != header[i]) && (i == 0))
-        {
-          readCnt++; // header[0] not found,continue
-        }
-        if (readCnt > (cnt - packetLen))
-        {
-          return false;
-        }
-      }
-
-      /* Find the correct fixed code */
-      if (isHeader)
-      {
-        for (i = 1; i < headerLen; i++)
-        {
-          checkSum += recBuf[i]; // Sum checkSum
-        }
-        for (i = headerLen; i < packetLen; i++) // Read subsequent data
-        {
-          if (_softSerial != NULL)
-          {
-            recBuf[i] = _softSerial->read();
-          }
-          else if (_hardSerial != NULL)
-          {
-            recBuf[i] = _hardSerial->read();
-          }
-          checkSum += recBuf[i]; // Sum checkSum
-        }
-        checkSum = checkSum - recBuf[packetLen - 1];
-
-        /* Compare whether the check code is correct */
-        if (checkSum == recBuf[packetLen - 1])
-        {
-          for (i = 0; i < packetLen; i++)
-          {
-            packet[i] = recBuf[i]; // True, assign data to packet[]
-          }
-          result = true;
-          break; // Exit "while (failCnt < 6)" loop
-        }
-        else
-        {
-          failCnt++; // Error, failCnt plus 1, return "while (failCnt < 6)" loop
-          checkSum = 0;
-        }
-      }
+      _cache[index] = value;
+      _cacheValid |= (1 << index);
+    }
+    else if (_reqFlags & REQ_WRITE)
+    {
+      _cacheValid &= ~(1 << index);
     }
   }
-  return result;
 }
 
 /**********************************************************
-Description: Get the data packet length of the slave machine replying to this command
-Parameters:  cmd: Command code
-Return: Data packet length
-Others: None
+Description: Store a register read issued by requestAllRegisters()
+Parameters:  status: Read status
+             value: Register value
+Return:      none
+Others:      none
 **********************************************************/
-uint8_t BM22S402x_1::getDataPacketLen(uint8_t cmd)
+void BM22S402x_1::storeSnapshot(uint8_t status, uint16_t value)
 {
-  uint8_t dataLen = 0;
-  switch (cmd)
+  BM22S402x_1_Registers *regs = _snapshot;
+  if (regs == NULL)
+  {
+    return;
+  }
+  if (status != READ_OK)
+  {
+    value = 0;
+  }
+  switch (_reqCmd)
   {
-  case 0x01:
-    dataLen = 2;
-    break;
-  case 0x02:
-    dataLen = 2;
-    break;
-  case 0x03:
-    dataLen = 10;
-    break;
   case 0x04:
-    dataLen = 1;
-    break;
-  case 0x05:
-    dataLen = 1;
+    regs->PIRControl = value;
+    regs->error[0] = status;
     break;
   case 0x06:
-    dataLen = 1;
-    break;
-  case 0x07:
-    dataLen = 1;
+    regs->sensitivity = value;
+    regs->error[1] = status;
     break;
   case 0x08:
-    dataLen = 2;
+    regs->delayTime = value;
+    regs->error[2] = status;
     break;
-  case 0x09:
-    dataLen = 2;
+  case 0x0a:
+    regs->blockTime = value;
+    regs->error[3] = status;
     break;
-  case 0x0A:
-    dataLen = 1;
-    break;
-  case 0x0B:
-    dataLen = 1;
-    break;
-  case 0x0C:
-    dataLen = 1;
-    break;
-  case 0x0D:
-    dataLen = 1;
-    break;
-  case 0x0F:
-    dataLen = 1;
-    break;
-  case 0x10:
-    dataLen = 2;
+  case 0x0c:
+    regs->status = value;
+    regs->error[4] = status;
+    _snapshot = NULL; // Last register of the snapshot
     break;
   default:
     break;
   }
-  return dataLen + 4;
+}
+
+/**********************************************************
+Description: STATUS pin interrupt entries, one per slot
+Parameters:  none
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1::statusISR0()
+{
+  _statusIrqOwner[0]->handleStatusEdge();
+}
+
+void BM22S402x_1::statusISR1()
+{
+  _statusIrqOwner[1]->handleStatusEdge();
+}
+
+void BM22S402x_1::statusISR2()
+{
+  _statusIrqOwner[2]->handleStatusEdge();
+}
+
+void BM22S402x_1::statusISR3()
+{
+  _statusIrqOwner[3]->handleStatusEdge();
+}
+
+/**********************************************************
+Description: Record a STATUS pin edge
+Parameters:  none
+Return:      none
+Others:      Single producer: runs in the interrupt, or from
+             pollStatusPin() when the pin has no interrupt
+**********************************************************/
+void BM22S402x_1::handleStatusEdge()
+{
+  uint8_t head = _eventHead, next;
+  bool level = digitalRead(_statusPin) == HIGH;
+  if (level == _statusLevel)
+  {
+    return; // Bounce or spurious interrupt
+  }
+  _statusLevel = level;
+  next = (head + 1) & (BM22S402x_1_EVENT_QUEUE_SIZE - 1);
+  if (next == _eventTail)
+  {
+    _eventDropCount++;
+    return;
+  }
+  _events[head].isTrigger = level;
+  _events[head].timeMs = millis();
+  _events[head].timeUs = micros();
+  _eventHead = next;
+}
+
+/**********************************************************
+Description: Detect STATUS pin edges without an interrupt
+Parameters:  none
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1::pollStatusPin()
+{
+  if ((digitalRead(_statusPin) == HIGH) != _statusLevel)
+  {
+    handleStatusEdge();
+  }
+}
+
+/**********************************************************
+Description: Assemble frames from the bytes already in the UART FIFO
+Parameters:  budget: Bytes that may still be taken, reduced by
+                     the bytes taken
+Return:      none
+Others:      Frame: 0xFB, cmd, len, data[len], checksum.
+             Every byte goes through the same framer, so replies and
+             AUTO mode packets can arrive in any order. Bytes beyond
+             the budget wait for the next update().
+**********************************************************/
+void BM22S402x_1::receiveFrames(uint16_t &budget)
+{
+  uint8_t chunk[16], count, i;
+  while (budget > 0 && (count = uartRead(chunk, (budget < sizeof(chunk)) ? budget : sizeof(chunk))) > 0)
+  {
+    budget -= count;
+    for (i = 0; i < count; i++)
+    {
+      _frames[_frameAssemble][_frameLen++] = chunk[i];
+      scanFrames();
+    }
+  }
+  if (_state == STATE_WAIT_REPLY && budget > 0 && (uint32_t)(millis() - _sendTime) > _replyTimeout)
+  {
+    failRequest(TIMEOUT_ERROR); // Not while the reply may still wait in the FIFO
+  }
+}
+
+/**********************************************************
+Description: Deliver the complete frames in the assembly buffer
+Parameters:  none
+Return:      none
+Others:      Bytes that cannot start a frame are dropped. Bytes after
+             a delivered frame stay buffered as the start of the next
+             one, so at most one incomplete frame is left.
+**********************************************************/
+void BM22S402x_1::scanFrames()
+{
+  uint8_t *frame, len, i;
+  while (_frameLen > 0)
+  {
+    frame = _frames[_frameAssemble];
+    if (!isFrameHeader(frame, _frameLen))
+    {
+      resyncFramer();
+      continue;
+    }
+    if (_frameLen < 4 || _frameLen < (frame[2] + 4))
+    {
+      return;
+    }
+    len = frame[2] + 4;
+    if (!handleFrame(frame))
+    {
+      resyncFramer(); // A frame may start inside the broken one
+      continue;
+    }
+    if (_frameLen < len)
+    {
+      return; // Receiver restarted from a callback
+    }
+    _frameLen -= len;
+    for (i = 0; i < _frameLen; i++)
+    {
+      _frames[_frameAssemble][i] = frame[len + i]; // Buffers may have been swapped
+    }
+  }
+}
+
+/**********************************************************
+Description: Deliver a complete frame
+Parameters:  frame: Frame at the start of the assembly buffer
+Return:      true: Frame delivered or dropped as unexpected
+             false: Checksum error
+Others:      AUTO mode packets are published, replies complete the
+             pending request, anything else(e.g. a late reply to a
+             request that already timed out) is dropped.
+**********************************************************/
+bool BM22S402x_1::handleFrame(const uint8_t *frame)
+{
+  uint8_t i, checkSum = 0, len = frame[2] + 4;
+  bool isReply = _state == STATE_WAIT_REPLY && (frame[1] == _reqCmd || frame[1] == 0xab);
+  for (i = 1; i < (len - 1); i++)
+  {
+    checkSum += frame[i];
+  }
+  if (checkSum != frame[len - 1])
+  {
+    STATS_ADD(checksumErrors, 1);
+    if (isReply)
+    {
+      failRequest(CHECK_ERROR);
+    }
+    return false;
+  }
+  if (frame[1] == 0x55 && frame[2] == 7)
+  {
+    publishInfoPacket();
+    return true;
+  }
+  for (i = 0; i < len; i++)
+  {
+    _rxBuf[i] = frame[i];
+  }
+  if (!isReply)
+  {
+    STATS_ADD(resyncBytes, frame[2] + 4);
+  }
+  else if (frame[1] == 0xab)
+  {
+    finishRequest(CMD_ERROR);
+  }
+  else
+  {
+    finishRequest(READ_OK);
+  }
+  return true;
+}
+
+/**********************************************************
+Description: Publish the AUTO mode packet in the assembly buffer
+Parameters:  none
+Return:      none
+Others:      Buffers are swapped, so the packet is not copied
+**********************************************************/
+void BM22S402x_1::publishInfoPacket()
+{
+  _infoPacket = _frames[_frameAssemble];
+  _frameAssemble ^= 1;
+  STATS_ADD(packetsReceived, 1);
+  if (_infoFresh && !_infoConsumed)
+  {
+    STATS_ADD(packetsDropped, 1); // Previous packet was never read
+  }
+  _infoFresh = true;
+  _infoConsumed = false;
+  _isStreaming = true;
+  _infoTimeMs = millis();
+  _infoTimeUs = micros();
+  if (_statusPin != 0xff && ((_infoPacket[7] & 0x01) == 0x01) != _statusLevel)
+  {
+    _statusMismatchCount++;
+  }
+  if (_history != NULL || _processor != NULL || _packetHandler != NULL)
+  {
+    BM22S402x_1_Sample sample;
+    getInfoSample(sample);
+    if (_history != NULL)
+    {
+      _history->write(sample);
+    }
+    if (_processor != NULL)
+    {
+      _processor->process(sample);
+    }
+    if (_packetHandler != NULL)
+    {
+      _packetHandler(sample);
+    }
+    _infoConsumed = true;
+  }
+  if (_group != NULL)
+  {
+    _group->onPacket(_groupIndex, _infoPacket);
+    _infoConsumed = true;
+  }
+  dispatchStatus(_infoPacket[7]);
+}
+
+/**********************************************************
+Description: Report STATUS register changes to the event handlers
+Parameters:  status: STATUS register value from a packet or 0x0C reply
+Return:      none
+Others:      The trigger bit is ignored when the STATUS pin is used
+**********************************************************/
+void BM22S402x_1::dispatchStatus(uint8_t status)
+{
+  uint8_t changed = status ^ _lastStatus;
+  _lastStatus = status;
+  if ((status & 0x20) == 0)
+  {
+    _stableSince = 0;
+    _isWarmupObserved = _isWarmingUp;
+  }
+  else if (_stableSince == 0)
+  {
+    _stableSince = millis() | 1; // Never 0
+    if (_isWarmupObserved)
+    {
+      /* First measurement replaces the default, later ones are averaged */
+      _warmupTime = (_warmupSamples == 0) ? _stableSince - _warmupStart
+                                          : (_warmupTime * 3 + (_stableSince - _warmupStart)) / 4;
+      _warmupSamples += (_warmupSamples < 0xff) ? 1 : 0;
+    }
+    _isWarmingUp = false;
+    _isWarmupObserved = false;
+  }
+  if (_statusPin == 0xff && (status & 0x01) != _notifiedTrigger)
+  {
+    dispatchTrigger(status & 0x01);
+  }
+  if ((changed & 0x20) && (status & 0x20) && _stableHandler != NULL)
+  {
+    _stableHandler(millis());
+  }
+}
+
+/**********************************************************
+Description: Restart the warm-up tracker
+Parameters:  startMs: millis() when the module starts warming up
+Return:      none
+Others:      Called by begin() and after a successful reset
+**********************************************************/
+void BM22S402x_1::startWarmup(uint32_t startMs)
+{
+  _warmupStart = startMs;
+  _stableSince = 0;
+  _lastStatus &= ~0x20; // onStable() fires again once the module is stable
+  _isWarmingUp = true;
+  _isWarmupObserved = false;
+}
+
+/**********************************************************
+Description: Report a trigger state change to the event handlers
+Parameters:  isTrigger: New trigger state
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1::dispatchTrigger(bool isTrigger)
+{
+  BM22S402x_1_EventHandler handler = isTrigger ? _triggerHandler : _releaseHandler;
+  _notifiedTrigger = isTrigger;
+  if (_occupancy != NULL)
+  {
+    _occupancy->record(isTrigger, millis());
+  }
+  if (handler != NULL)
+  {
+    handler(millis());
+  }
+}
+
+/**********************************************************
+Description: Check the frame header received so far
+Parameters:  frame: Frame start
+             len: Bytes received
+Return:      1: Header plausible as far as received
+             0: Not a frame the module sends
+Others:      Accepts packets(0x55), command errors(0xAB) and
+             replies no longer than the command table allows
+**********************************************************/
+bool BM22S402x_1::isFrameHeader(const uint8_t *frame, uint8_t len)
+{
+  uint8_t cmd = frame[1], maxLen;
+  if (frame[0] != 0xfb)
+  {
+    return false;
+  }
+  if (len < 2)
+  {
+    return true;
+  }
+  if (cmd == 0x55)
+  {
+    maxLen = 7;
+  }
+  else if (cmd == 0xab)
+  {
+    maxLen = 0;
+  }
+  else if (cmd > 0x00 && cmd < BM22S402x_1_CMD_COUNT && cmd != 0x0e)
+  {
+    maxLen = getReplyLen(cmd);
+  }
+  else
+  {
+    return false;
+  }
+  return len < 3 || frame[2] <= maxLen;
+}
+
+/**********************************************************
+Description: Drop bytes up to the next plausible frame header
+Parameters:  none
+Return:      none
+Others:      Bytes after a rejected header are rescanned,
+             so a frame starting inside a broken one is kept.
+             scanFrames() delivers it once complete.
+**********************************************************/
+void BM22S402x_1::resyncFramer()
+{
+  uint8_t *frame = _frames[_frameAssemble];
+  uint8_t i, start;
+  for (start = 1; start < _frameLen; start++)
+  {
+    if (isFrameHeader(frame + start, _frameLen - start))
+    {
+      break;
+    }
+  }
+  STATS_ADD(resyncBytes, start);
+  _frameLen -= start;
+  for (i = 0; i < _frameLen; i++)
+  {
+    frame[i] = frame[start + i];
+  }
+}
+
+/**********************************************************
+Description: Query whether the module is streaming AUTO mode packets
+Parameters:  none
+Return:      1: A packet arrived within BM22S402x_1_INFO_TIMEOUT
+             0: No recent packet, use commands
+Others:      Re-evaluated on every call, so the driver follows the
+             module between AUTO and command mode
+**********************************************************/
+bool BM22S402x_1::isStreaming()
+{
+  return _isStreaming && (uint32_t)(millis() - _infoTimeMs) <= BM22S402x_1_INFO_TIMEOUT;
+}
+
+/**********************************************************
+Description: Run the engine until all queued transactions complete
+Parameters:  none
+Return:      Status of the last completed transaction
+Others:      Used by the blocking API; polls without delay()
+**********************************************************/
+uint8_t BM22S402x_1::waitForReply()
+{
+  while (_state != STATE_IDLE)
+  {
+    update();
+    yield();
+  }
+  return _cmdStatus;
+}
+
+#if BM22S402x_1_STATS
+/**********************************************************
+Description: Add a reply latency to the statistics of the current command
+Parameters:  latencyUs: Time from request sent to reply validated(us)
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1::recordLatency(uint32_t latencyUs)
+{
+  BM22S402x_1_Latency *entry;
+  uint8_t bucket = 0;
+  uint16_t us = (latencyUs > 0xffff) ? 0xffff : latencyUs;
+  uint32_t limit;
+  if (_reqCmd >= BM22S402x_1_CMD_COUNT)
+  {
+    return;
+  }
+  entry = &_stats.latency[_reqCmd];
+  entry->count++;
+  entry->sumUs += us;
+  entry->minUs = (us < entry->minUs) ? us : entry->minUs;
+  entry->maxUs = (us > entry->maxUs) ? us : entry->maxUs;
+  for (limit = 500; bucket < BM22S402x_1_STATS_BUCKETS - 1 && us >= limit; limit <<= 1)
+  {
+    bucket++;
+  }
+  entry->histogram[bucket]++;
+}
+#endif
+
+/**********************************************************
+Description: clear UART FIFO
+Parameters:  none
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1::clear_UART_FIFO()
+{
+  uint8_t chunk[16], count;
+  while ((count = uartRead(chunk, sizeof(chunk))) > 0)
+  {
+    STATS_ADD(resyncBytes, count);
+  }
+}
+
+/**********************************************************
+Description: Read the bytes already received through UART
+Parameters: buf: Receives the bytes
+            len: Size of buf
+Return: Number of bytes read, 0 if the UART FIFO is empty
+Others: One transport call per chunk, no per-byte branching
+**********************************************************/
+uint8_t BM22S402x_1::uartRead(uint8_t buf[], uint8_t len)
+{
+  return _transport->read(buf, len);
+}
+
+/**********************************************************
+Description: Write data through UART
+Parameters: wbuf:The array for storing Data to be sent
+            wlen:Length of data sent
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1::writeBytes(uint8_t wbuf[], uint8_t wlen)
+{
+  _transport->write(wbuf, wlen);
+}
+
+/**********************************************************
+Description: Get the request data length of a write command
+Parameters:  cmd: Command code
+Return: Number of parameter bytes(1 for unknown commands)
+Others: Looked up in the command table
+**********************************************************/
+uint8_t BM22S402x_1::getRequestLen(uint8_t cmd)
+{
+  uint8_t len = 0;
+  if (cmd < BM22S402x_1_CMD_COUNT)
+  {
+    len = pgm_read_byte(&cmdTable[cmd]) >> 4;
+  }
+  return (len > 0) ? len : 1;
+}
+
+/**********************************************************
+Description: Get the data length of the slave machine replying to this command
+Parameters:  cmd: Command code
+Return: Reply data length
+Others: Looked up in the command table
+**********************************************************/
+uint8_t BM22S402x_1::getReplyLen(uint8_t cmd)
+{
+  if (cmd >= BM22S402x_1_CMD_COUNT)
+  {
+    return 0;
+  }
+  return pgm_read_byte(&cmdTable[cmd]) & 0x0f;
 }
\ No newline at end of file
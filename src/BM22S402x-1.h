@@ -4,12 +4,17 @@ Author:           BESTMODULES
 Description:      Define classes and required variables
 History:
 V1.0.1   -- initial version; 2023-2-16; Arduino IDE :v1.8.19
+V1.0.2   -- non-blocking command engine, AUTO mode frame receiver, transports, callbacks; 2026-10-17; Arduino IDE :v1.8.19
 ******************************************************************/
 #ifndef _BM22S402x_1_H_
 #define _BM22S402x_1_H_
 
 #include <Arduino.h>
 #include <SoftwareSerial.h>
+#include "BM22S402x-1_History.h"
+#include "BM22S402x-1_Processor.h"
+#include "BM22S402x-1_Occupancy.h"
+#include "BM22S402x-1_Transport.h"
 
 #define BM22S402x_1_BAUD 38400
 
@@ -19,6 +24,33 @@ V1.0.1   -- initial version; 2023-2-16; Arduino IDE :v1.8.19
 #define TIMEOUT_ERROR 2
 #define CMD_ERROR 3
 #define WRITE_FAILED 4
+#define BUSY 5
+
+#define BM22S402x_1_CMD_INTERVAL 10  // Communication interval after a transaction(ms)
+#define BM22S402x_1_REPLY_MARGIN 20  // Reply wait on top of the frame transfer time(ms)
+#define BM22S402x_1_RETRIES 2        // Resends after a check or timeout error
+#define BM22S402x_1_RETRY_BACKOFF 10 // Wait before the first resend, doubled per resend(ms)
+#define BM22S402x_1_FRAME_MAX 14     // Longest frame: device ID reply
+#define BM22S402x_1_CMD_COUNT 17     // Command codes 0x00~0x10
+#define BM22S402x_1_INFO_TIMEOUT 550 // Maximum wait for an AUTO mode packet(ms)
+#define BM22S402x_1_LINE_TIMEOUT 200 // Maximum wait for a shared line held by another module(ms)
+#define BM22S402x_1_WARMUP_TIME 30000 // Warm-up estimate until one has been measured(ms)
+#define BM22S402x_1_QUEUE_SIZE 8     // Commands that can be submitted ahead
+#define BM22S402x_1_EVENT_QUEUE_SIZE 8 // STATUS pin edges buffered(power of 2)
+#define BM22S402x_1_STATUS_IRQ_MAX 4   // Modules that can use a STATUS pin interrupt
+
+/* Received bytes framed per update(); bounds the time spent in one call */
+#ifndef BM22S402x_1_MAX_BYTES_PER_UPDATE
+#define BM22S402x_1_MAX_BYTES_PER_UPDATE 64
+#endif
+
+/* UART link statistics: 1 enables getStats()/resetStats(), 0 compiles them out.
+   It changes the class layout, so set it as a build flag for every translation
+   unit(e.g. -DBM22S402x_1_STATS=1), not with a #define in the sketch. */
+#ifndef BM22S402x_1_STATS
+#define BM22S402x_1_STATS 0
+#endif
+#define BM22S402x_1_STATS_BUCKETS 8 // Latency buckets: <0.5,<1,<2,<4,<8,<16,<32,>=32 ms
 
 /*PIR Trigger Level: L1~L8,
   L1: Highest sensitivity
@@ -32,40 +64,320 @@ V1.0.1   -- initial version; 2023-2-16; Arduino IDE :v1.8.19
 #define L7 6
 #define L8 7
 
+/* Register snapshot, filled by readAllRegisters() */
+struct BM22S402x_1_Registers
+{
+  uint8_t PIRControl;  // 0x04: PIR control register
+  uint8_t sensitivity; // 0x06: PIR trigger level(L1~L8)
+  uint16_t delayTime;  // 0x08: Delay time(unit: 0.1s)
+  uint8_t blockTime;   // 0x0A: Block time(unit: 0.2s)
+  uint8_t status;      // 0x0C: PIR STATUS register
+  uint8_t error[5];    // Read status of each register above, in the same order
+};
+
+/* Module configuration, used by readConfig()/applyConfig() */
+struct BM22S402x_1_Config
+{
+  uint8_t PIRControl;  // PIR control register(write 0x05)
+  uint8_t sensitivity; // PIR trigger level L1~L8(write 0x07)
+  uint16_t delayTime;  // Delay time, unit: 0.1s(write 0x09)
+  uint8_t blockTime;   // Block time, unit: 0.2s(write 0x0B)
+};
+
+/* STATUS pin edge, recorded by begin(statusPin) */
+struct BM22S402x_1_StatusEvent
+{
+  bool isTrigger;  // 1: Triggered(rising edge) 0: Released(falling edge)
+  uint32_t timeMs; // millis() at the edge
+  uint32_t timeUs; // micros() at the edge
+};
+
+#if BM22S402x_1_STATS
+/* Request to reply latency of one command code */
+struct BM22S402x_1_Latency
+{
+  uint16_t count;                               // Replies measured
+  uint16_t minUs;                               // Shortest latency(us)
+  uint16_t maxUs;                               // Longest latency(us)
+  uint32_t sumUs;                               // Total latency(us), mean = sumUs / count
+  uint16_t histogram[BM22S402x_1_STATS_BUCKETS]; // Replies per latency bucket
+};
+
+/* UART link statistics, returned by getStats() */
+struct BM22S402x_1_Stats
+{
+  uint32_t framesOK;        // Requests completed with READ_OK or WRITE_OK
+  uint32_t checksumErrors;  // Replies and information packets with a bad checksum
+  uint32_t timeouts;        // Commands that got no reply
+  uint32_t retries;         // Requests resent after a check or timeout error
+  uint32_t cmdErrors;       // Commands rejected by the module(0xFB 0xAB 0x00 0xAB)
+  uint32_t writeFailures;   // Writes whose reply differs from the value written
+  uint32_t resyncBytes;     // Bytes discarded: flushed before a command or not part of a frame
+  uint32_t packetsReceived; // AUTO mode packets assembled
+  uint32_t packetsDropped;  // AUTO mode packets neither read nor taken by a history, processor, handler or group
+  BM22S402x_1_Latency latency[BM22S402x_1_CMD_COUNT]; // By command code
+};
+#endif
+
+typedef void (*BM22S402x_1_ReplyHandler)(uint8_t cmd, uint8_t status, uint16_t value);
+typedef void (*BM22S402x_1_EventHandler)(uint32_t timeMs);
+typedef void (*BM22S402x_1_PacketHandler)(const BM22S402x_1_Sample &sample);
+typedef void (*BM22S402x_1_ErrorHandler)(uint8_t cmd, uint8_t status);
+
+class BM22S402x_1_Group;
+class BM22S402x_1_PowerManager;
+
+/* Command descriptor: code, request/reply data length(bytes) and reply value type */
+template <uint8_t Code, uint8_t RequestLen, uint8_t ReplyLen, typename T>
+struct BM22S402x_1_Command
+{
+  static const uint8_t code = Code;
+  static const uint8_t requestLen = RequestLen;
+  static const uint8_t replyLen = ReplyLen;
+  typedef T Value;
+};
+
 class BM22S402x_1
 {
 public:
+  /* Command table, used with read<>()/write<>() */
+  struct Cmd
+  {
+    typedef BM22S402x_1_Command<0x01, 0, 2, int16_t> RawPIR;
+    typedef BM22S402x_1_Command<0x02, 0, 2, uint16_t> FilteredPIR;
+    typedef BM22S402x_1_Command<0x03, 0, 10, void> DevID;
+    typedef BM22S402x_1_Command<0x04, 0, 1, uint8_t> PIRControl;
+    typedef BM22S402x_1_Command<0x05, 1, 1, uint8_t> SetPIRControl;
+    typedef BM22S402x_1_Command<0x06, 0, 1, uint8_t> Sensitivity;
+    typedef BM22S402x_1_Command<0x07, 1, 1, uint8_t> SetSensitivity;
+    typedef BM22S402x_1_Command<0x08, 0, 2, uint16_t> DelayTime;
+    typedef BM22S402x_1_Command<0x09, 2, 2, uint16_t> SetDelayTime;
+    typedef BM22S402x_1_Command<0x0a, 0, 1, uint8_t> BlockTime;
+    typedef BM22S402x_1_Command<0x0b, 1, 1, uint8_t> SetBlockTime;
+    typedef BM22S402x_1_Command<0x0c, 0, 1, uint8_t> Status;
+    typedef BM22S402x_1_Command<0x0d, 0, 0, void> Sleep;
+    typedef BM22S402x_1_Command<0x0f, 0, 0, void> Reset;
+    typedef BM22S402x_1_Command<0x10, 0, 2, int16_t> Temperature;
+  };
+
   BM22S402x_1(HardwareSerial *theSerial = &Serial);
   BM22S402x_1(uint8_t rxPin, uint8_t txPin);
+  BM22S402x_1(BM22S402x_1_Transport *transport);
   void begin();
+  void begin(uint8_t statusPin);
+  void end();
+  ~BM22S402x_1();
 
   uint8_t getDevID(uint8_t devID[]);
   uint16_t readCommand(uint8_t cmd);
   bool isStable();
+  uint32_t stableSince();
+  uint32_t getTimeToStable();
   bool isTrigger();
+  bool readStatusEvent(BM22S402x_1_StatusEvent &event);
+  uint16_t getStatusEventDropCount();
+  uint16_t getStatusMismatchCount();
   bool isInfoAvailable();
   void readInfopacket(uint8_t dataBuf[]);
+  const uint8_t *getInfoPacket();
+  void getInfoSample(BM22S402x_1_Sample &sample);
+  int16_t getInfoTemperature(bool isFahrenheit = false);
+  void attachHistory(BM22S402x_1_SampleBuffer *history);
+  void attachProcessor(BM22S402x_1_Processor *processor);
+  void attachOccupancy(BM22S402x_1_Occupancy *occupancy);
   uint16_t readPIR();
   uint16_t readRawPIR();
-  float readTemperature(bool isFahrenheit = false);
+  int16_t readTemperatureDeci(bool isFahrenheit = false);
+  /* Float wrapper, only links the float library when used */
+  float readTemperature(bool isFahrenheit = false) { return readTemperatureDeci(isFahrenheit) * 0.1f; }
+  static int16_t toFahrenheitDeci(int16_t deciCelsius);
+
+  uint8_t readAllRegisters(BM22S402x_1_Registers &regs);
+  bool requestAllRegisters(BM22S402x_1_Registers &regs);
+
+  uint8_t readConfig(BM22S402x_1_Config &config);
+  uint8_t applyConfig(const BM22S402x_1_Config &config, uint8_t *failedMask = NULL, bool rollback = true);
 
   uint8_t writeCommand(uint8_t cmd, uint16_t param);
+
+  /* Typed register access: read<BM22S402x_1::Cmd::FilteredPIR>() */
+  template <class C>
+  typename C::Value read()
+  {
+    static_assert(C::requestLen == 0 && C::replyLen > 0 && C::replyLen <= 2, "read<>() needs a register read command");
+    return (typename C::Value)readCommand(C::code);
+  }
+  template <class C>
+  uint8_t write(typename C::Value value)
+  {
+    static_assert(C::requestLen > 0, "write<>() needs a register write command");
+    return writeCommand(C::code, (uint16_t)value);
+  }
   uint8_t enablePIR(bool isEnable = true);
   uint8_t reset();
   uint8_t restoreDefault();
   uint8_t sleep();
 
+  bool submitCommand(uint8_t cmd);
+  bool submitCommand(uint8_t cmd, uint16_t param);
+  void update();
+  bool isBusy();
+  uint8_t getCommandStatus();
+  uint16_t getCommandResult();
+  void onReply(BM22S402x_1_ReplyHandler handler);
+  void setRetryPolicy(uint8_t retries, uint16_t backoffMs = BM22S402x_1_RETRY_BACKOFF);
+  void setReplyMargin(uint16_t marginMs);
+  void setPreserveStream(bool isPreserve);
+  void onTrigger(BM22S402x_1_EventHandler handler);
+  void onRelease(BM22S402x_1_EventHandler handler);
+  void onStable(BM22S402x_1_EventHandler handler);
+  void onPacket(BM22S402x_1_PacketHandler handler);
+  void onError(BM22S402x_1_ErrorHandler handler);
+  bool getCachedRegister(uint8_t cmd, uint16_t &value);
+  void invalidateCache();
+#if BM22S402x_1_STATS
+  const BM22S402x_1_Stats &getStats();
+  void resetStats();
+#endif
+
 private:
-  uint8_t _rxPin, _txPin;
-  bool _isAutoMode = true;
-  uint8_t _infoPacket[11] = {0};
+  friend class BM22S402x_1_Group;
+  friend class BM22S402x_1_PowerManager;
+  enum
+  {
+    STATE_IDLE,
+    STATE_PENDING,
+    STATE_WAIT_REPLY
+  };
+
+  /* STATUS pin edge queue: written by the interrupt, read by the sketch */
+  uint8_t _statusPin = 0xff;
+  int8_t _statusIrqSlot = -1;
+  volatile bool _statusLevel = false;
+  volatile BM22S402x_1_StatusEvent _events[BM22S402x_1_EVENT_QUEUE_SIZE];
+  volatile uint8_t _eventHead = 0;
+  volatile uint8_t _eventTail = 0;
+  volatile uint16_t _eventDropCount = 0;
+  uint16_t _statusMismatchCount = 0;
+  static BM22S402x_1 *_statusIrqOwner[BM22S402x_1_STATUS_IRQ_MAX];
+  static void statusISR0();
+  static void statusISR1();
+  static void statusISR2();
+  static void statusISR3();
+  void handleStatusEdge();
+  void pollStatusPin();
+
+  /* Frame receiver: replies go to the pending request, AUTO mode packets to the stream */
+  uint8_t _frames[2][BM22S402x_1_FRAME_MAX] = {{0}}; // One assembling, one holding the last packet
+  uint8_t _frameAssemble = 0;
+  uint8_t _frameLen = 0;
+  const uint8_t *_infoPacket = _frames[1];
+  bool _infoFresh = false;
+  bool _infoConsumed = false; // Packet fed to a history, processor, handler or group: not dropped if never read
+  bool _isStreaming = false; // At least one packet received
+  uint32_t _infoTimeMs = 0;
+  uint32_t _infoTimeUs = 0;
+  BM22S402x_1_SampleBuffer *_history = NULL;
+  BM22S402x_1_Processor *_processor = NULL;
+  BM22S402x_1_Occupancy *_occupancy = NULL;
+  void receiveFrames(uint16_t &budget);
+  void scanFrames();
+  bool handleFrame(const uint8_t *frame);
+  void publishInfoPacket();
+  static bool isFrameHeader(const uint8_t *frame, uint8_t len);
+  void resyncFramer();
+  bool isStreaming();
+
+  /* Transaction engine */
+  enum
+  {
+    REQ_WRITE = 0x01,
+    REQ_SNAPSHOT = 0x02,
+    REQ_TRACK = 0x04
+  };
+  struct Request
+  {
+    uint8_t cmd;
+    uint8_t flags;
+    uint16_t param;
+  };
+  Request _queue[BM22S402x_1_QUEUE_SIZE];
+  uint8_t _queueHead = 0;
+  uint8_t _queueCount = 0;
+  BM22S402x_1_Registers *_snapshot = NULL;
+  uint8_t _state = STATE_IDLE;
+  uint8_t _reqCmd = 0;
+  uint8_t _reqFlags = 0;
+  uint16_t _reqParam = 0;
+  uint8_t _txBuf[6] = {0};
+  uint8_t _txLen = 0;
+  uint8_t _rxBuf[BM22S402x_1_FRAME_MAX] = {0}; // Last reply frame
+  uint8_t _cmdStatus = READ_OK;
+  uint16_t _cmdResult = 0;
+  uint32_t _sendTime = 0;
+  uint16_t _replyTimeout = 0;
+  uint16_t _replyMargin = BM22S402x_1_REPLY_MARGIN;
+  uint8_t _retryLimit = BM22S402x_1_RETRIES;
+  uint16_t _retryBackoff = BM22S402x_1_RETRY_BACKOFF;
+  uint8_t _reqAttempt = 0; // Resends of the current request
+  bool _isWaitingLine = false; // Request refused by a shared line since _lineWaitStart
+  uint32_t _lineWaitStart = 0;
+  bool _preserveStream = true;
+  bool _isUpdating = false; // Handlers run inside update(), commands they submit must not restart it
+  uint32_t _guardStart = 0;
+  uint16_t _guardTime = 0;
+  BM22S402x_1_ReplyHandler _replyHandler = NULL;
+  BM22S402x_1_Group *_group = NULL;
+  uint8_t _groupIndex = 0;
+  BM22S402x_1_PowerManager *_power = NULL; // Told about every completed command
+
+  /* Event callbacks, dispatched from update() */
+  BM22S402x_1_EventHandler _triggerHandler = NULL;
+  BM22S402x_1_EventHandler _releaseHandler = NULL;
+  BM22S402x_1_EventHandler _stableHandler = NULL;
+  BM22S402x_1_PacketHandler _packetHandler = NULL;
+  BM22S402x_1_ErrorHandler _errorHandler = NULL;
+  uint8_t _lastStatus = 0;       // Last STATUS register value seen in a packet or 0x0C reply
+  bool _notifiedTrigger = false; // Trigger state last reported to the handlers
+  void dispatchStatus(uint8_t status);
+
+  /* Warm-up tracker, fed with the stable bit by dispatchStatus() */
+  uint32_t _warmupStart = 0;  // millis() at begin() or reset
+  uint32_t _stableSince = 0;  // millis() when the stable bit was set, 0 if not stable
+  uint32_t _warmupTime = BM22S402x_1_WARMUP_TIME;
+  uint8_t _warmupSamples = 0; // Warm-ups measured
+  bool _isWarmingUp = false;
+  bool _isWarmupObserved = false; // Not-stable status seen since the warm-up started
+  void startWarmup(uint32_t startMs);
+  void dispatchTrigger(bool isTrigger);
+
+  /* Shadow registers: PIR control, sensitivity, delay time, block time */
+  uint16_t _cache[4] = {0};
+  uint8_t _cacheValid = 0;
+  uint8_t _trackStatus[4] = {0}; // Status of REQ_TRACK commands per register
+  static int8_t cacheIndex(uint8_t cmd);
+  void updateCache(uint8_t status, uint16_t value);
+  bool enqueue(uint8_t cmd, uint8_t flags, uint16_t param);
+  void storeSnapshot(uint8_t status, uint16_t value);
+  void sendRequest();
+  void failRequest(uint8_t status);
+  void finishRequest(uint8_t status);
+  uint8_t waitForReply();
+
   void clear_UART_FIFO();
+  uint8_t uartRead(uint8_t buf[], uint8_t len);
   void writeBytes(uint8_t wbuf[], uint8_t wlen);
-  uint8_t readBytes(uint8_t rbuf[], uint8_t rlen, uint16_t timeout = 10);
-  bool findPacket(uint8_t header[], uint8_t headerLen, uint8_t packet[], uint8_t packetLen);
-  uint8_t getDataPacketLen(uint8_t cmd);
-  HardwareSerial *_hardSerial = NULL;
-  SoftwareSerial *_softSerial = NULL;
+  static uint8_t getRequestLen(uint8_t cmd);
+  static uint8_t getReplyLen(uint8_t cmd);
+  BM22S402x_1_HardSerial _hardLink; // Link of the HardwareSerial constructor
+  BM22S402x_1_Transport *_transport;  // All UART I/O goes through this link
+
+  /* Last so that the offsets of the members above do not depend on the switch */
+#if BM22S402x_1_STATS
+  uint32_t _sendTimeUs = 0;
+  BM22S402x_1_Stats _stats;
+  void recordLatency(uint32_t latencyUs);
+#endif
 };
 
 #endif
@@ -0,0 +1,278 @@
+/*****************************************************************
+File:          BM22S402x-1_Bus.cpp
+Author:        BESTMODULES
+Description:   Several BM22S402x-1 modules on one half-duplex UART
+               line: arbitration of the line between the modules
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Bus.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Start the shared line
+Parameters: baud: Baud rate
+Return: None
+Others: Called by the module's begin(); the line is opened once
+**********************************************************/
+void BM22S402x_1_BusDevice::begin(uint32_t baud)
+{
+  if (_selectPin != 0xff)
+  {
+    pinMode(_selectPin, OUTPUT);
+    digitalWrite(_selectPin, LOW);
+  }
+  _bus->begin(baud);
+}
+
+/**********************************************************
+Description: Copy received bytes
+Parameters: buf: Receives the bytes
+            len: Size of buf
+Return: Number of bytes copied, 0 if none was received or
+        another module holds the line
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_BusDevice::read(uint8_t buf[], uint8_t len)
+{
+  if (_bus->_owner != _index)
+  {
+    return 0;
+  }
+  return _bus->_link.read(buf, len);
+}
+
+/**********************************************************
+Description: Send bytes
+Parameters: buf: Bytes to send
+            len: Number of bytes
+Return: None
+Others: Dropped if another module holds the line
+**********************************************************/
+void BM22S402x_1_BusDevice::write(const uint8_t buf[], uint8_t len)
+{
+  if (_bus->acquire(_index))
+  {
+    _bus->_link.write(buf, len);
+  }
+}
+
+/**********************************************************
+Description: Request the line for a command
+Parameters: None
+Return:   1: The module holds the line
+          0: Another module holds it, try again later
+Others: Called by the module before a request is sent
+**********************************************************/
+bool BM22S402x_1_BusDevice::acquire()
+{
+  return _bus->acquire(_index);
+}
+
+/**********************************************************
+Description: Give the line back
+Parameters: None
+Return: None
+Others: Called by the module once the reply has been handled
+**********************************************************/
+void BM22S402x_1_BusDevice::release()
+{
+  _bus->release(_index);
+}
+
+/**********************************************************
+Description: Constructor
+Parameters: link: Link of the shared line, e.g. a BM22S402x_1_HardSerial
+                  behind an external transceiver; must outlive the bus
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_SharedBus::BM22S402x_1_SharedBus(BM22S402x_1_Transport &link) : _link(link)
+{
+}
+
+/**********************************************************
+Description: Add a module to the line
+Parameters: selectPin: Pin that connects the module to the line
+                       while HIGH, 0xff if the line needs none
+Return: Link to construct the module with, NULL if the bus is full
+Others: The module's index is count() - 1
+**********************************************************/
+BM22S402x_1_Transport *BM22S402x_1_SharedBus::addDevice(uint8_t selectPin)
+{
+  BM22S402x_1_BusDevice *device;
+  if (_count >= BM22S402x_1_BUS_MAX)
+  {
+    return NULL;
+  }
+  device = &_devices[_count];
+  device->_bus = this;
+  device->_index = _count;
+  device->_selectPin = selectPin;
+  device->_hasID = false;
+  _count++;
+  return device;
+}
+
+/**********************************************************
+Description: Get the number of modules on the line
+Parameters: None
+Return: Number of modules
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_SharedBus::count()
+{
+  return _count;
+}
+
+/**********************************************************
+Description: Read and store the device ID of a module
+Parameters: index: Module index(0 ~ count()-1)
+            sensor: Module object constructed with that index's link
+Return:   1: ID stored, indexOf() finds the module by it
+          0: No reply, or another module held the line
+Others: Blocks for the 0x03 transaction. Use it after installation
+        to map each select pin to a physical module.
+**********************************************************/
+bool BM22S402x_1_SharedBus::identify(uint8_t index, BM22S402x_1 &sensor)
+{
+  if (index >= _count || sensor.getDevID(_devices[index]._devID) != READ_OK)
+  {
+    return false;
+  }
+  _devices[index]._hasID = true;
+  return true;
+}
+
+/**********************************************************
+Description: Find the module with a device ID
+Parameters: devID: Device ID(10 bytes) as returned by getDevID()
+Return: Module index, -1 if no identified module has this ID
+Others: None
+**********************************************************/
+int8_t BM22S402x_1_SharedBus::indexOf(const uint8_t devID[10])
+{
+  uint8_t i;
+  for (i = 0; i < _count; i++)
+  {
+    if (_devices[i]._hasID && memcmp(_devices[i]._devID, devID, 10) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**********************************************************
+Description: Get the module holding the line
+Parameters: None
+Return: Module index, 0xff if the line is free
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_SharedBus::getOwner()
+{
+  return _owner;
+}
+
+/**********************************************************
+Description: Get the number of times the line was granted
+Parameters: None
+Return: Grants since the bus was constructed
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_SharedBus::getGrantCount()
+{
+  return _grantCount;
+}
+
+/**********************************************************
+Description: Get the number of refused line requests
+Parameters: None
+Return: Requests made while another module held the line
+Others: A high count against getGrantCount() means the line is
+        the bottleneck
+**********************************************************/
+uint32_t BM22S402x_1_SharedBus::getWaitCount()
+{
+  return _waitCount;
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/**********************************************************
+Description: Open the line on the first call
+Parameters:  baud: Baud rate
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_SharedBus::begin(uint32_t baud)
+{
+  if (!_isStarted)
+  {
+    _link.begin(baud);
+    _isStarted = true;
+  }
+}
+
+/**********************************************************
+Description: Grant the line to a module if it is free
+Parameters:  index: Module index
+Return:      1: The module holds the line
+             0: Another module holds it
+Others:      Bytes left from the previous owner are dropped
+             before the new owner is selected
+**********************************************************/
+bool BM22S402x_1_SharedBus::acquire(uint8_t index)
+{
+  if (_owner == index)
+  {
+    return true;
+  }
+  if (_owner != 0xff)
+  {
+    _waitCount++;
+    return false;
+  }
+  drain();
+  _owner = index;
+  _grantCount++;
+  if (_devices[index]._selectPin != 0xff)
+  {
+    digitalWrite(_devices[index]._selectPin, HIGH);
+  }
+  return true;
+}
+
+/**********************************************************
+Description: Free the line if a module holds it
+Parameters:  index: Module index
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_SharedBus::release(uint8_t index)
+{
+  if (_owner != index)
+  {
+    return;
+  }
+  if (_devices[index]._selectPin != 0xff)
+  {
+    digitalWrite(_devices[index]._selectPin, LOW);
+  }
+  _owner = 0xff;
+}
+
+/**********************************************************
+Description: Drop the received bytes nobody owns
+Parameters:  none
+Return:      none
+Others:      Bounded by BM22S402x_1_MAX_BYTES_PER_UPDATE
+**********************************************************/
+void BM22S402x_1_SharedBus::drain()
+{
+  uint8_t chunk[16], count;
+  uint16_t budget = BM22S402x_1_MAX_BYTES_PER_UPDATE;
+  while (budget > 0 && (count = _link.read(chunk, (budget < sizeof(chunk)) ? budget : sizeof(chunk))) > 0)
+  {
+    budget -= count;
+  }
+}
@@ -0,0 +1,75 @@
+/*****************************************************************
+File:             BM22S402x-1_Bus.h
+Author:           BESTMODULES
+Description:      Several BM22S402x-1 modules on one half-duplex UART
+                  line, one select pin per module
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_BUS_H_
+#define _BM22S402x_1_BUS_H_
+
+#include "BM22S402x-1.h"
+
+#define BM22S402x_1_BUS_MAX 8 // Modules per shared line
+
+class BM22S402x_1_SharedBus;
+
+/* Link of one module on a shared line; obtained from BM22S402x_1_SharedBus::addDevice() */
+class BM22S402x_1_BusDevice : public BM22S402x_1_Transport
+{
+public:
+  void begin(uint32_t baud);
+  uint8_t read(uint8_t buf[], uint8_t len);
+  void write(const uint8_t buf[], uint8_t len);
+  bool acquire();
+  void release();
+
+private:
+  friend class BM22S402x_1_SharedBus;
+  BM22S402x_1_SharedBus *_bus;
+  uint8_t _index;
+  uint8_t _selectPin;
+  bool _hasID;
+  uint8_t _devID[10];
+};
+
+/*
+  Frames carry no module address, so replies cannot be told apart on
+  the line. The bus grants the line to one module at a time and drives
+  its select pin(HIGH: selected), e.g. the enable of the transceiver
+  or multiplexer channel of that module; whatever arrives while a
+  module owns the line is its reply. Modules must not stream AUTO
+  mode packets. A command of one module fails with TIMEOUT_ERROR
+  after BM22S402x_1_LINE_TIMEOUT if another module keeps the line,
+  e.g. because the sketch blocks on the first without updating the
+  holder.
+*/
+class BM22S402x_1_SharedBus
+{
+public:
+  BM22S402x_1_SharedBus(BM22S402x_1_Transport &link);
+  BM22S402x_1_Transport *addDevice(uint8_t selectPin);
+  uint8_t count();
+  bool identify(uint8_t index, BM22S402x_1 &sensor);
+  int8_t indexOf(const uint8_t devID[10]);
+  uint8_t getOwner();
+  uint32_t getGrantCount();
+  uint32_t getWaitCount();
+
+private:
+  friend class BM22S402x_1_BusDevice;
+  BM22S402x_1_Transport &_link;
+  BM22S402x_1_BusDevice _devices[BM22S402x_1_BUS_MAX];
+  uint8_t _count = 0;
+  uint8_t _owner = 0xff; // Index of the module holding the line, 0xff if free
+  bool _isStarted = false;
+  uint32_t _grantCount = 0;
+  uint32_t _waitCount = 0;
+  void begin(uint32_t baud);
+  bool acquire(uint8_t index);
+  void release(uint8_t index);
+  void drain();
+};
+
+#endif
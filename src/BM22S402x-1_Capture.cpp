@@ -0,0 +1,359 @@
+/*****************************************************************
+File:          BM22S402x-1_Capture.cpp
+Author:        BESTMODULES
+Description:   Recording of the received byte stream and replay of
+               a recording into the driver
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Capture.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Constructor, recording into RAM
+Parameters: link: Link connected to the module, must outlive the recorder
+            buf: Receives the recording
+            size: Size of buf
+Return: None
+Others: Recording stops when buf is full, see getDropped()
+**********************************************************/
+BM22S402x_1_RecordingTransport::BM22S402x_1_RecordingTransport(BM22S402x_1_Transport &link, uint8_t buf[], uint32_t size)
+    : _link(link)
+{
+  _buf = buf;
+  _bufSize = size;
+  _sink = NULL;
+}
+
+/**********************************************************
+Description: Constructor, streaming the recording out
+Parameters: link: Link connected to the module, must outlive the recorder
+            sink: Receives the recording, e.g. an SD card File or a
+                  second serial port
+Return: None
+Others: The sink should not block for longer than a packet interval
+**********************************************************/
+BM22S402x_1_RecordingTransport::BM22S402x_1_RecordingTransport(BM22S402x_1_Transport &link, Print &sink)
+    : _link(link)
+{
+  _buf = NULL;
+  _bufSize = 0;
+  _sink = &sink;
+}
+
+/**********************************************************
+Description: Start the link and a new recording
+Parameters: baud: Baud rate
+Return: None
+Others: Called by the driver's begin()
+**********************************************************/
+void BM22S402x_1_RecordingTransport::begin(uint32_t baud)
+{
+  _link.begin(baud);
+  start();
+}
+
+/**********************************************************
+Description: Read received bytes and record them
+Parameters: buf: Receives the bytes
+            len: Size of buf
+Return: Number of bytes copied, 0 if none was received
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_RecordingTransport::read(uint8_t buf[], uint8_t len)
+{
+  uint8_t count = _link.read(buf, len);
+  if (count > 0 && _isRecording)
+  {
+    record(buf, count);
+  }
+  return count;
+}
+
+/**********************************************************
+Description: Send bytes
+Parameters: buf: Bytes to send
+            len: Number of bytes
+Return: None
+Others: Sent bytes are not recorded
+**********************************************************/
+void BM22S402x_1_RecordingTransport::write(const uint8_t buf[], uint8_t len)
+{
+  _link.write(buf, len);
+}
+
+/**********************************************************
+Description: Request the line for a command
+Parameters: None
+Return:   1: The module holds the line
+          0: Another module holds it, try again later
+Others: Forwarded to the recorded link, e.g. a shared bus device
+**********************************************************/
+bool BM22S402x_1_RecordingTransport::acquire()
+{
+  return _link.acquire();
+}
+
+/**********************************************************
+Description: Give the line back
+Parameters: None
+Return: None
+Others: Forwarded to the recorded link
+**********************************************************/
+void BM22S402x_1_RecordingTransport::release()
+{
+  _link.release();
+}
+
+/**********************************************************
+Description: Discard the recording and record from now on
+Parameters: None
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_RecordingTransport::start()
+{
+  _size = 0;
+  _dropped = 0;
+  _lastTime = millis();
+  _isRecording = true;
+}
+
+/**********************************************************
+Description: Stop recording, the recording is kept
+Parameters: None
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_RecordingTransport::stop()
+{
+  _isRecording = false;
+}
+
+/**********************************************************
+Description: Query whether received bytes are recorded
+Parameters: None
+Return:   1: Recording
+          0: Stopped, or the RAM buffer is full
+Others: None
+**********************************************************/
+bool BM22S402x_1_RecordingTransport::isRecording()
+{
+  return _isRecording && _dropped == 0;
+}
+
+/**********************************************************
+Description: Get the recording
+Parameters: None
+Return: RAM buffer holding getSize() bytes, NULL with a sink
+Others: Pass it to BM22S402x_1_ReplayTransport to play it back
+**********************************************************/
+const uint8_t *BM22S402x_1_RecordingTransport::getData()
+{
+  return _buf;
+}
+
+/**********************************************************
+Description: Get the size of the recording
+Parameters: None
+Return: Bytes stored in the RAM buffer or written to the sink
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_RecordingTransport::getSize()
+{
+  return _size;
+}
+
+/**********************************************************
+Description: Get the received bytes missing from the recording
+Parameters: None
+Return: Bytes received after the RAM buffer filled up
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_RecordingTransport::getDropped()
+{
+  return _dropped;
+}
+
+/**********************************************************
+Description: Constructor
+Parameters: data: Recording made by BM22S402x_1_RecordingTransport
+            size: Size of the recording
+            isProgmem: true: data is in flash(PROGMEM)
+                       false: data is in RAM(default)
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_ReplayTransport::BM22S402x_1_ReplayTransport(const uint8_t data[], uint32_t size, bool isProgmem)
+{
+  _data = data;
+  _size = size;
+  _isProgmem = isProgmem;
+}
+
+/**********************************************************
+Description: Set the playback speed
+Parameters: factor: 1: Original timing(default)
+                    2~255: Accelerated by this factor
+                    0: Every byte is available at once
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_ReplayTransport::setSpeed(uint8_t factor)
+{
+  _speed = factor;
+}
+
+/**********************************************************
+Description: Start the playback from the beginning
+Parameters: baud: Baud rate, unused
+Return: None
+Others: Called by the driver's begin()
+**********************************************************/
+void BM22S402x_1_ReplayTransport::begin(uint32_t baud)
+{
+  (void)baud;
+  rewind();
+}
+
+/**********************************************************
+Description: Copy the recorded bytes that are due
+Parameters: buf: Receives the bytes
+            len: Size of buf
+Return: Number of bytes copied, 0 if none is due
+Others: A record becomes due when the playback time reaches
+        its recording time
+**********************************************************/
+uint8_t BM22S402x_1_ReplayTransport::read(uint8_t buf[], uint8_t len)
+{
+  uint32_t now = millis(), delay, pos;
+  uint8_t count = 0, data, shift;
+
+  _playTime += (now - _lastTime) * _speed;
+  _lastTime = now;
+  while (count < len && _pos < _size)
+  {
+    if (_remaining == 0)
+    {
+      pos = _pos;
+      delay = 0;
+      shift = 0;
+      do
+      {
+        data = byteAt(pos++);
+        delay |= (uint32_t)(data & 0x7f) << shift;
+        shift += 7;
+      } while ((data & 0x80) && pos < _size && shift < 35);
+      if (_speed != 0 && (int32_t)(_playTime - (_recordTime + delay)) < 0)
+      {
+        break; // Not due yet
+      }
+      _recordTime += delay;
+      _remaining = (pos < _size) ? byteAt(pos++) : 0;
+      _pos = pos;
+      continue;
+    }
+    buf[count++] = byteAt(_pos++);
+    _remaining--;
+  }
+  if (_speed == 0)
+  {
+    _playTime = _recordTime;
+  }
+  return count;
+}
+
+/**********************************************************
+Description: Discard bytes sent by the driver
+Parameters: buf: Bytes to send
+            len: Number of bytes
+Return: None
+Others: Replies to commands come only from the recording
+**********************************************************/
+void BM22S402x_1_ReplayTransport::write(const uint8_t buf[], uint8_t len)
+{
+  (void)buf;
+  (void)len;
+}
+
+/**********************************************************
+Description: Restart the playback
+Parameters: None
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_ReplayTransport::rewind()
+{
+  _pos = 0;
+  _remaining = 0;
+  _recordTime = 0;
+  _playTime = 0;
+  _lastTime = millis();
+}
+
+/**********************************************************
+Description: Query whether the whole recording was played
+Parameters: None
+Return:   1: Every byte was read
+          0: Bytes are left
+Others: None
+**********************************************************/
+bool BM22S402x_1_ReplayTransport::isDone()
+{
+  return _pos >= _size;
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/**********************************************************
+Description: Append a record
+Parameters:  data: Received bytes
+             count: Number of bytes
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_RecordingTransport::record(const uint8_t data[], uint8_t count)
+{
+  uint8_t header[BM22S402x_1_RECORD_HEADER_MAX], headerLen = 0;
+  uint32_t now = millis(), delay = now - _lastTime;
+
+  if (_buf != NULL && (_dropped > 0 || _size + BM22S402x_1_RECORD_HEADER_MAX + count > _bufSize))
+  {
+    _dropped += count; // Keep the recording contiguous: nothing after a gap
+    return;
+  }
+  _lastTime = now;
+  do
+  {
+    header[headerLen] = delay & 0x7f;
+    delay >>= 7;
+    header[headerLen++] |= (delay != 0) ? 0x80 : 0;
+  } while (delay != 0);
+  header[headerLen++] = count;
+
+  if (_buf != NULL)
+  {
+    memcpy(_buf + _size, header, headerLen);
+    memcpy(_buf + _size + headerLen, data, count);
+  }
+  else
+  {
+    _sink->write(header, headerLen);
+    _sink->write(data, count);
+  }
+  _size += headerLen + count;
+}
+
+/**********************************************************
+Description: Read a recording byte
+Parameters:  pos: Offset in the recording
+Return:      The byte
+Others:      none
+**********************************************************/
+uint8_t BM22S402x_1_ReplayTransport::byteAt(uint32_t pos)
+{
+  if (_isProgmem)
+  {
+    return pgm_read_byte(_data + pos);
+  }
+  return _data[pos];
+}
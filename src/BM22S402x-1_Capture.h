@@ -0,0 +1,79 @@
+/*****************************************************************
+File:             BM22S402x-1_Capture.h
+Author:           BESTMODULES
+Description:      Recording of the received byte stream and replay of
+                  a recording into the driver
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_CAPTURE_H_
+#define _BM22S402x_1_CAPTURE_H_
+
+#include "BM22S402x-1_Transport.h"
+
+/*
+  Recording format, one record per chunk read by the driver:
+    delay  - ms since the previous record(since begin() for the first),
+             7 bits per byte, least significant first, bit 7 set if
+             another byte follows
+    count  - number of data bytes, 1~255
+    data   - the received bytes
+*/
+#define BM22S402x_1_RECORD_HEADER_MAX 6 // 5-byte delay + count
+
+/* Records the bytes received through another link */
+class BM22S402x_1_RecordingTransport : public BM22S402x_1_Transport
+{
+public:
+  BM22S402x_1_RecordingTransport(BM22S402x_1_Transport &link, uint8_t buf[], uint32_t size);
+  BM22S402x_1_RecordingTransport(BM22S402x_1_Transport &link, Print &sink);
+  void begin(uint32_t baud);
+  uint8_t read(uint8_t buf[], uint8_t len);
+  void write(const uint8_t buf[], uint8_t len);
+  bool acquire();
+  void release();
+  void start();
+  void stop();
+  bool isRecording();
+  const uint8_t *getData();
+  uint32_t getSize();
+  uint32_t getDropped();
+
+private:
+  BM22S402x_1_Transport &_link;
+  uint8_t *_buf;        // RAM buffer, NULL when writing to _sink
+  uint32_t _bufSize;
+  Print *_sink;
+  uint32_t _size = 0;    // Recording bytes stored or written
+  uint32_t _dropped = 0; // Received bytes that did not fit into _buf
+  uint32_t _lastTime = 0;
+  bool _isRecording = false;
+  void record(const uint8_t data[], uint8_t count);
+};
+
+/* Plays a recording back as if it came from the module */
+class BM22S402x_1_ReplayTransport : public BM22S402x_1_Transport
+{
+public:
+  BM22S402x_1_ReplayTransport(const uint8_t data[], uint32_t size, bool isProgmem = false);
+  void setSpeed(uint8_t factor);
+  void begin(uint32_t baud);
+  uint8_t read(uint8_t buf[], uint8_t len);
+  void write(const uint8_t buf[], uint8_t len);
+  void rewind();
+  bool isDone();
+
+private:
+  const uint8_t *_data;
+  uint32_t _size;
+  bool _isProgmem;
+  uint8_t _speed = 1;
+  uint32_t _pos = 0;        // Next recording byte
+  uint8_t _remaining = 0;   // Data bytes left in the current record
+  uint32_t _recordTime = 0; // Recording time of the current record(ms)
+  uint32_t _playTime = 0;   // Recording time reached by the playback(ms)
+  uint32_t _lastTime = 0;
+  uint8_t byteAt(uint32_t pos);
+};
+
+#endif
@@ -0,0 +1,378 @@
+/*****************************************************************
+File:          BM22S402x-1_Group.cpp
+Author:        BESTMODULES
+Description:   Drive several BM22S402x-1 modules on separate UARTs
+               and merge their events into one stream
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Group.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Add a module to the group
+Parameters: sensor: Module object, must outlive the group
+Return:   1: Added, its index is count() - 1
+          0: Group full
+Others: The group sees every AUTO mode packet and command
+        completion of the module and takes over its STATUS pin events.
+**********************************************************/
+bool BM22S402x_1_Group::add(BM22S402x_1 &sensor)
+{
+  if (_count >= BM22S402x_1_GROUP_MAX)
+  {
+    return false;
+  }
+  sensor._group = this;
+  sensor._groupIndex = _count;
+  _sensors[_count] = &sensor;
+  _lastStatus[_count] = READ_OK;
+  _count++;
+  return true;
+}
+
+/**********************************************************
+Description: Get the number of modules in the group
+Parameters: None
+Return: Number of modules
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Group::count()
+{
+  return _count;
+}
+
+/**********************************************************
+Description: Get a module of the group
+Parameters: index: Module index(0 ~ count()-1)
+Return: Module object
+Others: None
+**********************************************************/
+BM22S402x_1 &BM22S402x_1_Group::getSensor(uint8_t index)
+{
+  return *_sensors[index];
+}
+
+/**********************************************************
+Description: Initial every module of the group
+Parameters: None
+Return: None
+Others: Modules that need begin(statusPin) can be started
+        individually instead.
+**********************************************************/
+void BM22S402x_1_Group::begin()
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    _sensors[i]->begin();
+  }
+}
+
+/**********************************************************
+Description: Advance every module once and collect their events
+Parameters: None
+Return: None
+Others: Never blocks. The module served first rotates on each call
+        so no port is starved; requests on different ports are in
+        flight at the same time.
+**********************************************************/
+void BM22S402x_1_Group::update()
+{
+  uint8_t i, index = _next;
+  for (i = 0; i < _count; i++)
+  {
+    serviceSensor(index);
+    index = (index + 1 == _count) ? 0 : index + 1;
+  }
+  if (_count > 0)
+  {
+    _next = (_next + 1 == _count) ? 0 : _next + 1;
+  }
+}
+
+/**********************************************************
+Description: Submit a read-type command to one module
+Parameters: index: Module index
+            cmd: Command code
+Return:   1: Command queued
+          0: Bad index or queue full
+Others: Completion is reported as a BM22S402x_1_EVENT_REPLY event
+**********************************************************/
+bool BM22S402x_1_Group::submitCommand(uint8_t index, uint8_t cmd)
+{
+  if (index >= _count)
+  {
+    return false;
+  }
+  return _sensors[index]->submitCommand(cmd);
+}
+
+/**********************************************************
+Description: Submit a write command to one module
+Parameters: index: Module index
+            cmd: Command code for writing registers
+            param: 8-bit or 16-bit data
+Return:   1: Command queued
+          0: Bad index or queue full
+Others: Completion is reported as a BM22S402x_1_EVENT_REPLY event
+**********************************************************/
+bool BM22S402x_1_Group::submitCommand(uint8_t index, uint8_t cmd, uint16_t param)
+{
+  if (index >= _count)
+  {
+    return false;
+  }
+  return _sensors[index]->submitCommand(cmd, param);
+}
+
+/**********************************************************
+Description: Submit the same read-type command to every module
+Parameters: cmd: Command code
+Return: Number of modules that accepted the command
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Group::submitAll(uint8_t cmd)
+{
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    n += _sensors[i]->submitCommand(cmd);
+  }
+  return n;
+}
+
+/**********************************************************
+Description: Submit the same write command to every module
+Parameters: cmd: Command code for writing registers
+            param: 8-bit or 16-bit data
+Return: Number of modules that accepted the command
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Group::submitAll(uint8_t cmd, uint16_t param)
+{
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    n += _sensors[i]->submitCommand(cmd, param);
+  }
+  return n;
+}
+
+/**********************************************************
+Description: Query whether any module has a command in progress
+Parameters: None
+Return:   1: At least one module busy
+          0: All modules idle
+Others: None
+**********************************************************/
+bool BM22S402x_1_Group::isBusy()
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_sensors[i]->isBusy())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**********************************************************
+Description: Read the same register from every module concurrently
+Parameters: cmd: Command code for reading registers
+            values[]: Receives one value per module(count() elements)
+            errors[]: Receives one status per module, may be NULL
+Return: Number of modules that failed
+Others: Takes one round-trip in total instead of one per module
+**********************************************************/
+uint8_t BM22S402x_1_Group::readAll(uint8_t cmd, uint16_t values[], uint8_t errors[])
+{
+  uint8_t i, failed = 0;
+  waitIdle();
+  submitAll(cmd);
+  waitIdle();
+  for (i = 0; i < _count; i++)
+  {
+    values[i] = (_lastStatus[i] == READ_OK) ? _sensors[i]->getCommandResult() : 0;
+    if (errors != NULL)
+    {
+      errors[i] = _lastStatus[i];
+    }
+    failed += (_lastStatus[i] != READ_OK);
+  }
+  return failed;
+}
+
+/**********************************************************
+Description: Write the same register of every module concurrently
+Parameters: cmd: Command code for writing registers
+            param: 8-bit or 16-bit data
+            errors[]: Receives one status per module, may be NULL
+Return: Number of modules that failed
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Group::writeAll(uint8_t cmd, uint16_t param, uint8_t errors[])
+{
+  uint8_t i, failed = 0;
+  waitIdle();
+  submitAll(cmd, param);
+  waitIdle();
+  for (i = 0; i < _count; i++)
+  {
+    if (errors != NULL)
+    {
+      errors[i] = _lastStatus[i];
+    }
+    failed += (_lastStatus[i] != WRITE_OK);
+  }
+  return failed;
+}
+
+/**********************************************************
+Description: Get the oldest event of the merged event stream
+Parameters: event: Receives the event, tagged with the module index
+Return:   1: Event read
+          0: No event
+Others: None
+**********************************************************/
+bool BM22S402x_1_Group::readEvent(BM22S402x_1_GroupEvent &event)
+{
+  if (_eventCount == 0)
+  {
+    return false;
+  }
+  event = _events[_eventHead];
+  _eventHead = (_eventHead + 1) % BM22S402x_1_GROUP_EVENTS;
+  _eventCount--;
+  return true;
+}
+
+/**********************************************************
+Description: Get the number of events waiting to be read
+Parameters: None
+Return: Number of events
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Group::available()
+{
+  return _eventCount;
+}
+
+/**********************************************************
+Description: Get the number of events lost because the stream was full
+Parameters: None
+Return: Drop counter
+Others: None
+**********************************************************/
+uint16_t BM22S402x_1_Group::getEventDropCount()
+{
+  return _eventDropCount;
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/**********************************************************
+Description: Advance one module and turn its STATUS pin edges into events
+Parameters:  index: Module index
+Return:      none
+Others:      Packets and replies are reported by the module's update()
+**********************************************************/
+void BM22S402x_1_Group::serviceSensor(uint8_t index)
+{
+  BM22S402x_1 &sensor = *_sensors[index];
+  BM22S402x_1_StatusEvent edge;
+
+  sensor.update();
+  while (sensor.readStatusEvent(edge))
+  {
+    setTrigger(index, edge.isTrigger, edge.timeMs);
+  }
+}
+
+/**********************************************************
+Description: Record a trigger state change
+Parameters:  index: Module index
+             isTrigger: New trigger state
+             timeMs: Time of the change
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_Group::setTrigger(uint8_t index, bool isTrigger, uint32_t timeMs)
+{
+  uint8_t mask = 1 << index;
+  if (((_triggered & mask) != 0) == isTrigger)
+  {
+    return;
+  }
+  _triggered ^= mask;
+  pushEvent(index, isTrigger ? BM22S402x_1_EVENT_TRIGGER : BM22S402x_1_EVENT_RELEASE, 0, 0, 0, timeMs);
+}
+
+/**********************************************************
+Description: Append an event to the merged stream
+Parameters:  index, type, cmd, status, value, timeMs: Event fields
+Return:      none
+Others:      When the stream is full the new event is dropped and counted
+**********************************************************/
+void BM22S402x_1_Group::pushEvent(uint8_t index, uint8_t type, uint8_t cmd, uint8_t status, uint16_t value, uint32_t timeMs)
+{
+  BM22S402x_1_GroupEvent *event;
+  if (_eventCount >= BM22S402x_1_GROUP_EVENTS)
+  {
+    _eventDropCount++;
+    return;
+  }
+  event = &_events[(_eventHead + _eventCount) % BM22S402x_1_GROUP_EVENTS];
+  event->sensor = index;
+  event->type = type;
+  event->cmd = cmd;
+  event->status = status;
+  event->value = value;
+  event->timeMs = timeMs;
+  _eventCount++;
+}
+
+/**********************************************************
+Description: Information packet reported by a module of the group
+Parameters:  index: Module index
+             packet: Whole AUTO mode frame(0xFB 0x55 0x07 data[7] checksum)
+Return:      none
+Others:      Called from the module's update() for every packet. Trigger
+             state comes from the packets unless the module was started
+             with begin(statusPin).
+**********************************************************/
+void BM22S402x_1_Group::onPacket(uint8_t index, const uint8_t packet[])
+{
+  pushEvent(index, BM22S402x_1_EVENT_PACKET, 0x55, packet[7], ((uint16_t)packet[6] << 8) | packet[5], millis());
+  if (_sensors[index]->_statusPin == 0xff)
+  {
+    setTrigger(index, (packet[7] & 0x01) == 0x01, millis());
+  }
+}
+
+/**********************************************************
+Description: Command completion reported by a module of the group
+Parameters:  index: Module index
+             cmd, status, value: Completed command
+Return:      none
+Others:      Called from the module's update()
+**********************************************************/
+void BM22S402x_1_Group::onReply(uint8_t index, uint8_t cmd, uint8_t status, uint16_t value)
+{
+  _lastStatus[index] = status;
+  pushEvent(index, BM22S402x_1_EVENT_REPLY, cmd, status, value, millis());
+}
+
+/**********************************************************
+Description: Run the group until no module has a command in progress
+Parameters:  none
+Return:      none
+Others:      Polls without delay()
+**********************************************************/
+void BM22S402x_1_Group::waitIdle()
+{
+  while (isBusy())
+  {
+    update();
+    yield();
+  }
+}
@@ -0,0 +1,72 @@
+/*****************************************************************
+File:             BM22S402x-1_Group.h
+Author:           BESTMODULES
+Description:      Drive several BM22S402x-1 modules on separate UARTs
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_GROUP_H_
+#define _BM22S402x_1_GROUP_H_
+
+#include "BM22S402x-1.h"
+
+#define BM22S402x_1_GROUP_MAX 8     // Modules per group
+#define BM22S402x_1_GROUP_EVENTS 16 // Merged events buffered
+
+/* Group event types */
+#define BM22S402x_1_EVENT_PACKET 0  // AUTO mode information packet received
+#define BM22S402x_1_EVENT_REPLY 1   // Command completed
+#define BM22S402x_1_EVENT_TRIGGER 2 // Module triggered
+#define BM22S402x_1_EVENT_RELEASE 3 // Module released
+
+struct BM22S402x_1_GroupEvent
+{
+  uint8_t sensor;  // Index of the module in the group
+  uint8_t type;    // BM22S402x_1_EVENT_xxx
+  uint8_t cmd;     // REPLY: command code
+  uint8_t status;  // REPLY: command status; PACKET: PIR STATUS Register Value
+  uint16_t value;  // REPLY: value replied; PACKET: filtered PIR value
+  uint32_t timeMs; // millis() when the event was recorded
+};
+
+class BM22S402x_1_Group
+{
+public:
+  bool add(BM22S402x_1 &sensor);
+  uint8_t count();
+  BM22S402x_1 &getSensor(uint8_t index);
+  void begin();
+  void update();
+
+  bool submitCommand(uint8_t index, uint8_t cmd);
+  bool submitCommand(uint8_t index, uint8_t cmd, uint16_t param);
+  uint8_t submitAll(uint8_t cmd);
+  uint8_t submitAll(uint8_t cmd, uint16_t param);
+  bool isBusy();
+  uint8_t readAll(uint8_t cmd, uint16_t values[], uint8_t errors[] = NULL);
+  uint8_t writeAll(uint8_t cmd, uint16_t param, uint8_t errors[] = NULL);
+
+  bool readEvent(BM22S402x_1_GroupEvent &event);
+  uint8_t available();
+  uint16_t getEventDropCount();
+
+private:
+  friend class BM22S402x_1;
+  BM22S402x_1 *_sensors[BM22S402x_1_GROUP_MAX];
+  uint8_t _count = 0;
+  uint8_t _next = 0;                // Sensor served first by the next update()
+  uint8_t _triggered = 0;           // Last trigger state, one bit per sensor
+  uint8_t _lastStatus[BM22S402x_1_GROUP_MAX]; // Last command status per sensor
+  BM22S402x_1_GroupEvent _events[BM22S402x_1_GROUP_EVENTS];
+  uint8_t _eventHead = 0;
+  uint8_t _eventCount = 0;
+  uint16_t _eventDropCount = 0;
+  void serviceSensor(uint8_t index);
+  void setTrigger(uint8_t index, bool isTrigger, uint32_t timeMs);
+  void pushEvent(uint8_t index, uint8_t type, uint8_t cmd, uint8_t status, uint16_t value, uint32_t timeMs);
+  void onPacket(uint8_t index, const uint8_t packet[]);
+  void onReply(uint8_t index, uint8_t cmd, uint8_t status, uint16_t value);
+  void waitIdle();
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*****************************************************************
+File:          BM22S402x-1_History.cpp
+Author:        BESTMODULES
+Description:   Ring buffer of decoded AUTO mode information packets
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_History.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Store a sample
+Parameters: sample: Decoded information packet
+Return: None
+Others: When the buffer is full the oldest sample is
+        overwritten and the drop counter is incremented.
+**********************************************************/
+void BM22S402x_1_SampleBuffer::write(const BM22S402x_1_Sample &sample)
+{
+  uint8_t tail;
+  if (_count == _capacity)
+  {
+    _head = (_head + 1 == _capacity) ? 0 : _head + 1;
+    _count--;
+    _dropCount++;
+  }
+  tail = _head + _count;
+  if (tail >= _capacity)
+  {
+    tail -= _capacity;
+  }
+  _storage[tail] = sample;
+  _count++;
+}
+
+/**********************************************************
+Description: Remove the oldest sample
+Parameters: sample: Receives the oldest sample
+Return:   1: Sample read
+          0: Buffer empty
+Others: None
+**********************************************************/
+bool BM22S402x_1_SampleBuffer::read(BM22S402x_1_Sample &sample)
+{
+  if (_count == 0)
+  {
+    return false;
+  }
+  sample = _storage[_head];
+  _head = (_head + 1 == _capacity) ? 0 : _head + 1;
+  _count--;
+  return true;
+}
+
+/**********************************************************
+Description: Remove up to maxCount samples, oldest first
+Parameters: samples[]: Receives the samples
+            maxCount: Size of samples[]
+Return: Number of samples read
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_SampleBuffer::read(BM22S402x_1_Sample samples[], uint8_t maxCount)
+{
+  uint8_t n = 0;
+  while (n < maxCount && read(samples[n]))
+  {
+    n++;
+  }
+  return n;
+}
+
+/**********************************************************
+Description: Get the oldest sample without removing it
+Parameters: sample: Receives the oldest sample
+Return:   1: Sample available
+          0: Buffer empty
+Others: None
+**********************************************************/
+bool BM22S402x_1_SampleBuffer::peek(BM22S402x_1_Sample &sample)
+{
+  if (_count == 0)
+  {
+    return false;
+  }
+  sample = _storage[_head];
+  return true;
+}
+
+/**********************************************************
+Description: Get the number of stored samples
+Parameters: None
+Return: Number of samples waiting to be read
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_SampleBuffer::available()
+{
+  return _count;
+}
+
+/**********************************************************
+Description: Get the buffer capacity
+Parameters: None
+Return: Maximum number of stored samples
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_SampleBuffer::capacity()
+{
+  return _capacity;
+}
+
+/**********************************************************
+Description: Get the number of samples overwritten before being read
+Parameters: None
+Return: Drop counter
+Others: Cleared by clear()
+**********************************************************/
+uint32_t BM22S402x_1_SampleBuffer::getDropCount()
+{
+  return _dropCount;
+}
+
+/**********************************************************
+Description: Discard all samples and reset the drop counter
+Parameters: None
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_SampleBuffer::clear()
+{
+  _head = 0;
+  _count = 0;
+  _dropCount = 0;
+}
+
+/*-------------------------------------  Protected  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: storage: Sample array owned by the derived class
+            capacity: Number of elements in storage
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_SampleBuffer::BM22S402x_1_SampleBuffer(BM22S402x_1_Sample *storage, uint8_t capacity)
+{
+  _storage = storage;
+  _capacity = capacity;
+}
@@ -0,0 +1,62 @@
+/*****************************************************************
+File:             BM22S402x-1_History.h
+Author:           BESTMODULES
+Description:      Ring buffer of decoded AUTO mode information packets
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_HISTORY_H_
+#define _BM22S402x_1_HISTORY_H_
+
+#include <Arduino.h>
+
+/* One decoded information packet */
+struct BM22S402x_1_Sample
+{
+  uint16_t rawPIR;     // Raw PIR value(AD)
+  uint16_t PIR;        // Filtered PIR value(AD)
+  uint8_t status;      // PIR STATUS Register Value
+  int16_t temperature; // Temperature(unit: 0.1 Centigrade)
+  uint32_t timeMs;     // millis() when the packet completed
+  uint32_t timeUs;     // micros() when the packet completed
+};
+
+/* Allocation-free sample FIFO; storage is supplied by BM22S402x_1_History<N> */
+class BM22S402x_1_SampleBuffer
+{
+public:
+  void write(const BM22S402x_1_Sample &sample);
+  bool read(BM22S402x_1_Sample &sample);
+  uint8_t read(BM22S402x_1_Sample samples[], uint8_t maxCount);
+  bool peek(BM22S402x_1_Sample &sample);
+  uint8_t available();
+  uint8_t capacity();
+  uint32_t getDropCount();
+  void clear();
+
+protected:
+  BM22S402x_1_SampleBuffer(BM22S402x_1_Sample *storage, uint8_t capacity);
+
+private:
+  BM22S402x_1_Sample *_storage;
+  uint8_t _capacity;
+  uint8_t _head = 0;  // Index of the oldest sample
+  uint8_t _count = 0; // Number of stored samples
+  uint32_t _dropCount = 0;
+};
+
+/* Sample history with a compile-time capacity(1~255 samples) */
+template <uint8_t N>
+class BM22S402x_1_History : public BM22S402x_1_SampleBuffer
+{
+public:
+  BM22S402x_1_History() : BM22S402x_1_SampleBuffer(_samples, N)
+  {
+    static_assert(N > 0, "BM22S402x_1_History<N> needs N >= 1");
+  }
+
+private:
+  BM22S402x_1_Sample _samples[N];
+};
+
+#endif
@@ -0,0 +1,304 @@
+/*****************************************************************
+File:          BM22S402x-1_Occupancy.cpp
+Author:        BESTMODULES
+Description:   Occupancy aggregation of the trigger state
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Occupancy.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Set the aggregation window length
+Parameters: windowMs: Window length(default 60000 ms)
+Return: None
+Others: Restarts the aggregation, see reset()
+**********************************************************/
+void BM22S402x_1_Occupancy::setWindow(uint32_t windowMs)
+{
+  _windowMs = (windowMs > 0) ? windowMs : 1;
+  reset();
+}
+
+/**********************************************************
+Description: Record the trigger state
+Parameters: isTrigger: true: Trigger state set
+                       false: Trigger state cleared
+            timeMs: millis() of the change
+Return: None
+Others: Called by the driver for every trigger and release once
+        attached with attachOccupancy(). Repeated states are ignored.
+**********************************************************/
+void BM22S402x_1_Occupancy::record(bool isTrigger, uint32_t timeMs)
+{
+  uint32_t idle;
+  advance(timeMs);
+  if (isTrigger == _isOccupied)
+  {
+    return;
+  }
+  if (isTrigger)
+  {
+    idle = timeMs - ((_triggerCount > 0) ? _lastRelease : _startMs);
+    _longestIdle = (idle > _longestIdle) ? idle : _longestIdle;
+    _triggerCount++;
+    _current.triggerCount += (_current.triggerCount < 0xffff) ? 1 : 0;
+    _lastTrigger = timeMs;
+    _markMs = timeMs;
+  }
+  else
+  {
+    _activeMs += timeMs - _lastTrigger;
+    _current.activeMs += timeMs - _markMs;
+    _lastRelease = timeMs;
+  }
+  _isOccupied = isTrigger;
+}
+
+/**********************************************************
+Description: Query the trigger state
+Parameters: None
+Return:   1: Occupied(trigger state set)
+          0: Idle
+Others: None
+**********************************************************/
+bool BM22S402x_1_Occupancy::isOccupied()
+{
+  return _isOccupied;
+}
+
+/**********************************************************
+Description: Get the duration of the current occupancy
+Parameters: None
+Return: Time since the trigger(ms), 0 when idle
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getOccupiedTime()
+{
+  return _isOccupied ? millis() - _lastTrigger : 0;
+}
+
+/**********************************************************
+Description: Get the duration of the current idle period
+Parameters: None
+Return: Time since the release, or since reset() before the
+        first trigger(ms), 0 when occupied
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getIdleTime()
+{
+  if (_isOccupied)
+  {
+    return 0;
+  }
+  return millis() - ((_triggerCount > 0) ? _lastRelease : _startMs);
+}
+
+/**********************************************************
+Description: Get the time of the last trigger
+Parameters: None
+Return: millis() of the last trigger, 0 if none
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getLastTrigger()
+{
+  return _lastTrigger;
+}
+
+/**********************************************************
+Description: Get the time of the last release
+Parameters: None
+Return: millis() of the last release, 0 if none
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getLastRelease()
+{
+  return _lastRelease;
+}
+
+/**********************************************************
+Description: Get the number of triggers
+Parameters: None
+Return: Triggers since reset()
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getTriggerCount()
+{
+  return _triggerCount;
+}
+
+/**********************************************************
+Description: Get the total occupied time
+Parameters: None
+Return: Time the trigger state was set since reset()(ms),
+        including the current occupancy
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getActiveTime()
+{
+  return _activeMs + getOccupiedTime();
+}
+
+/**********************************************************
+Description: Get the longest idle gap
+Parameters: None
+Return: Longest time without occupancy since reset()(ms),
+        including the current idle period
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getLongestIdle()
+{
+  uint32_t idle = getIdleTime();
+  return (idle > _longestIdle) ? idle : _longestIdle;
+}
+
+/**********************************************************
+Description: Get the trigger rate
+Parameters: None
+Return: Triggers per hour over the stored windows and the
+        current one
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Occupancy::getTriggerRate()
+{
+  uint32_t now = millis(), seconds;
+  advance(now);
+  seconds = (_count * _windowMs + (now - _current.startMs)) / 1000;
+  return (_storedTriggers + _current.triggerCount) * 3600UL / ((seconds > 0) ? seconds : 1);
+}
+
+/**********************************************************
+Description: Get the number of windows available
+Parameters: None
+Return: Stored completed windows + 1(the current window)
+Others: None
+**********************************************************/
+uint8_t BM22S402x_1_Occupancy::getWindowCount()
+{
+  advance(millis());
+  return _count + 1;
+}
+
+/**********************************************************
+Description: Get the activity of a window
+Parameters: index: 0: Current window, up to now
+                   1~getWindowCount()-1: Completed windows, 1 is the newest
+            window: Receives the window
+Return:   1: Window copied
+          0: No window with this index
+Others: None
+**********************************************************/
+bool BM22S402x_1_Occupancy::getWindow(uint8_t index, BM22S402x_1_OccupancyWindow &window)
+{
+  uint32_t now = millis();
+  advance(now);
+  if (index == 0)
+  {
+    window = _current;
+    window.activeMs += _isOccupied ? now - _markMs : 0;
+    return true;
+  }
+  if (index > _count)
+  {
+    return false;
+  }
+  window = _windows[(_head + _capacity - (index - 1)) % _capacity];
+  return true;
+}
+
+/**********************************************************
+Description: Clear the counters and start a new window
+Parameters: None
+Return: None
+Others: The trigger state is kept
+**********************************************************/
+void BM22S402x_1_Occupancy::reset()
+{
+  _startMs = millis();
+  _head = 0;
+  _count = 0;
+  _storedTriggers = 0;
+  _current.startMs = _startMs;
+  _current.triggerCount = 0;
+  _current.activeMs = 0;
+  _markMs = _startMs;
+  _lastTrigger = _isOccupied ? _startMs : 0;
+  _lastRelease = 0;
+  _triggerCount = 0;
+  _activeMs = 0;
+  _longestIdle = 0;
+}
+
+/*-------------------------------------  Protected  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: windows: Storage for the completed windows
+            capacity: Number of windows in the storage
+Return: None
+Others: Used by BM22S402x_1_OccupancyTracker<N>
+**********************************************************/
+BM22S402x_1_Occupancy::BM22S402x_1_Occupancy(BM22S402x_1_OccupancyWindow *windows, uint8_t capacity)
+{
+  _windows = windows;
+  _capacity = capacity;
+  reset();
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/**********************************************************
+Description: Close the windows that ended before a time
+Parameters:  timeMs: Current millis()
+Return:      none
+Others:      At most capacity + 1 windows are closed per call;
+             older ones would be overwritten anyway
+**********************************************************/
+void BM22S402x_1_Occupancy::advance(uint32_t timeMs)
+{
+  uint32_t elapsed = timeMs - _current.startMs, windows;
+  if ((int32_t)elapsed < 0 || elapsed < _windowMs)
+  {
+    return;
+  }
+  windows = elapsed / _windowMs;
+  closeWindow(_current.startMs + _windowMs);
+  windows--;
+  if (windows > _capacity)
+  {
+    _current.startMs += (windows - _capacity) * _windowMs;
+    _markMs = _current.startMs;
+    windows = _capacity;
+  }
+  while (windows-- > 0)
+  {
+    closeWindow(_current.startMs + _windowMs);
+  }
+}
+
+/**********************************************************
+Description: Store the current window and start the next one
+Parameters:  endMs: End of the current window
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_Occupancy::closeWindow(uint32_t endMs)
+{
+  if (_isOccupied)
+  {
+    _current.activeMs += endMs - _markMs;
+    _markMs = endMs;
+  }
+  _head = (_head + 1) % _capacity;
+  if (_count == _capacity)
+  {
+    _storedTriggers -= _windows[_head].triggerCount;
+  }
+  else
+  {
+    _count++;
+  }
+  _windows[_head] = _current;
+  _storedTriggers += _current.triggerCount;
+  _current.startMs = endMs;
+  _current.triggerCount = 0;
+  _current.activeMs = 0;
+}
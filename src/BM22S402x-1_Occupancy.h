@@ -0,0 +1,80 @@
+/*****************************************************************
+File:             BM22S402x-1_Occupancy.h
+Author:           BESTMODULES
+Description:      Occupancy aggregation of the trigger state: counts
+                  and active time per window, longest idle gap and
+                  trigger rate
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_OCCUPANCY_H_
+#define _BM22S402x_1_OCCUPANCY_H_
+
+#include <Arduino.h>
+
+/* Activity of one aggregation window */
+struct BM22S402x_1_OccupancyWindow
+{
+  uint32_t startMs;      // millis() when the window started
+  uint16_t triggerCount; // Triggers in the window
+  uint32_t activeMs;     // Time the trigger state was set in the window
+};
+
+/* Trigger state aggregator; window history storage is supplied by BM22S402x_1_OccupancyTracker<N> */
+class BM22S402x_1_Occupancy
+{
+public:
+  void setWindow(uint32_t windowMs);
+  void record(bool isTrigger, uint32_t timeMs);
+
+  bool isOccupied();
+  uint32_t getOccupiedTime();
+  uint32_t getIdleTime();
+  uint32_t getLastTrigger();
+  uint32_t getLastRelease();
+  uint32_t getTriggerCount();
+  uint32_t getActiveTime();
+  uint32_t getLongestIdle();
+  uint32_t getTriggerRate();
+  uint8_t getWindowCount();
+  bool getWindow(uint8_t index, BM22S402x_1_OccupancyWindow &window);
+  void reset();
+
+protected:
+  BM22S402x_1_Occupancy(BM22S402x_1_OccupancyWindow *windows, uint8_t capacity);
+
+private:
+  BM22S402x_1_OccupancyWindow *_windows;
+  uint8_t _capacity;
+  uint32_t _windowMs = 60000;
+  uint8_t _head = 0;            // Index of the newest completed window
+  uint8_t _count = 0;           // Completed windows stored
+  uint32_t _storedTriggers = 0; // Triggers in the stored windows
+  BM22S402x_1_OccupancyWindow _current;
+  bool _isOccupied = false;
+  uint32_t _startMs = 0; // millis() of reset()
+  uint32_t _markMs = 0;  // Active time of the current window is counted up to here
+  uint32_t _lastTrigger = 0;
+  uint32_t _lastRelease = 0;
+  uint32_t _triggerCount = 0;
+  uint32_t _activeMs = 0; // Active time of the completed occupancies
+  uint32_t _longestIdle = 0;
+  void advance(uint32_t timeMs);
+  void closeWindow(uint32_t endMs);
+};
+
+/* Aggregator keeping the last N completed windows(1~255) */
+template <uint8_t N>
+class BM22S402x_1_OccupancyTracker : public BM22S402x_1_Occupancy
+{
+public:
+  BM22S402x_1_OccupancyTracker() : BM22S402x_1_Occupancy(_windows, N)
+  {
+    static_assert(N > 0, "BM22S402x_1_OccupancyTracker<N> needs N >= 1");
+  }
+
+private:
+  BM22S402x_1_OccupancyWindow _windows[N];
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*****************************************************************
+File:          BM22S402x-1_Power.cpp
+Author:        BESTMODULES
+Description:   Duty cycling of a BM22S402x-1 module: sleep between
+               sampling windows, wake on a timer or the STATUS pin
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Power.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: sensor: Module object, must outlive the manager
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_PowerManager::BM22S402x_1_PowerManager(BM22S402x_1 &sensor) : _sensor(sensor)
+{
+  resetMetrics();
+}
+
+/**********************************************************
+Description: Set the sampling window and the sleep time
+Parameters: awakeMs: Time the module stays awake after each wake-up(default 1000)
+            sleepMs: Time the module sleeps between windows,
+                     0 never sleeps(default 9000)
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_PowerManager::setDutyCycle(uint32_t awakeMs, uint32_t sleepMs)
+{
+  _awakeMs = awakeMs;
+  _sleepMs = sleepMs;
+}
+
+/**********************************************************
+Description: Wake the module early when the STATUS pin goes high
+Parameters: isEnable: true: Wake on trigger(default)
+                      false: Wake on the timer only
+Return: None
+Others: Requires sensor.begin(statusPin)
+**********************************************************/
+void BM22S402x_1_PowerManager::setWakeOnTrigger(bool isEnable)
+{
+  _wakeOnTrigger = isEnable;
+}
+
+/**********************************************************
+Description: Register the host sleep function
+Parameters: hook: Called from update() while the module sleeps with the
+                  time left until the next wake-up, NULL to remove
+Return: None
+Others: The hook may put the host to sleep; it should return early
+        when an interrupt(e.g. the STATUS pin) wakes the host.
+**********************************************************/
+void BM22S402x_1_PowerManager::setHostSleep(BM22S402x_1_SleepHook hook)
+{
+  _hostSleep = hook;
+}
+
+/**********************************************************
+Description: Start duty cycling with a sampling window
+Parameters: None
+Return: None
+Others: Call after sensor.begin()
+**********************************************************/
+void BM22S402x_1_PowerManager::begin()
+{
+  _sensor._power = this;
+  _lastUpdate = millis();
+  _isReady = false;
+  _checkTime = _lastUpdate - BM22S402x_1_POWER_CHECK; // Check stability now
+  enterState(POWER_AWAKE);
+}
+
+/**********************************************************
+Description: Run the duty cycle
+Parameters: None
+Return: None
+Others: Call from loop() instead of sensor.update(). Commands of
+        the manager go through the sensor's command queue.
+**********************************************************/
+void BM22S402x_1_PowerManager::update()
+{
+  uint32_t now = millis(), elapsed;
+  bool isTrigger;
+
+  /* Time accounting since the previous call */
+  elapsed = now - _lastUpdate;
+  _lastUpdate = now;
+  if (_state == POWER_ASLEEP)
+  {
+    _metrics.sleepMs += elapsed;
+  }
+  else
+  {
+    _metrics.awakeMs += elapsed;
+  }
+  if (_wasBusy)
+  {
+    _metrics.uartActiveMs += elapsed;
+  }
+
+  _sensor.update();
+  _wasBusy = _sensor.isBusy();
+  if (_pendingCmd != 0)
+  {
+    if (!_isPendingDone)
+    {
+      return;
+    }
+    finishCommand();
+  }
+
+  elapsed = now - _stateStart;
+  if (_state == POWER_AWAKE)
+  {
+    if (_sleepMs > 0 && elapsed >= _awakeMs && !_wasBusy)
+    {
+      submit(0x0d);
+    }
+    else if (!_isReady && (uint32_t)(now - _checkTime) >= BM22S402x_1_POWER_CHECK && !_wasBusy)
+    {
+      submit(0x0c);
+    }
+    return;
+  }
+
+  isTrigger = _wakeOnTrigger && _sensor._statusPin != 0xff && _sensor._statusLevel;
+  if (_isWakeRequested || isTrigger || elapsed >= _sleepMs)
+  {
+    _metrics.wakeCount++;
+    _metrics.triggerWakeCount += isTrigger ? 1 : 0;
+    enterState(POWER_AWAKE);
+    submit(0x0c); // Any UART activity wakes the module
+  }
+  else if (_hostSleep != NULL)
+  {
+    _hostSleep(_sleepMs - elapsed);
+  }
+}
+
+/**********************************************************
+Description: Wake the module now, or restart the sampling window
+Parameters: None
+Return: None
+Others: The wake-up happens on the next update()
+**********************************************************/
+void BM22S402x_1_PowerManager::wake()
+{
+  if (_state == POWER_ASLEEP)
+  {
+    _isWakeRequested = true;
+  }
+  else
+  {
+    _stateStart = millis();
+  }
+}
+
+/**********************************************************
+Description: Query whether the module is awake
+Parameters: None
+Return:   1: Awake(sampling window)
+          0: Asleep
+Others: None
+**********************************************************/
+bool BM22S402x_1_PowerManager::isAwake()
+{
+  return _state == POWER_AWAKE;
+}
+
+/**********************************************************
+Description: Query whether the module can be used
+Parameters: None
+Return:   1: Awake and a 0x0C reply reported it stable
+          0: Asleep or still warming up
+Others: None
+**********************************************************/
+bool BM22S402x_1_PowerManager::isReady()
+{
+  return _state == POWER_AWAKE && _isReady;
+}
+
+/**********************************************************
+Description: Get the energy related counters
+Parameters: None
+Return: Counters since the last resetMetrics()
+Others: Times are accumulated by update(), with its granularity
+**********************************************************/
+const BM22S402x_1_PowerMetrics &BM22S402x_1_PowerManager::getMetrics()
+{
+  return _metrics;
+}
+
+/**********************************************************
+Description: Clear the energy related counters
+Parameters: None
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_PowerManager::resetMetrics()
+{
+  _metrics.awakeMs = 0;
+  _metrics.sleepMs = 0;
+  _metrics.uartActiveMs = 0;
+  _metrics.wakeCount = 0;
+  _metrics.triggerWakeCount = 0;
+}
+
+/*-------------------------------------  Private  -------------------------------------*/
+/**********************************************************
+Description: Submit a manager command
+Parameters:  cmd: 0x0C(wake-up and stability check) or 0x0D(sleep)
+Return:      none
+Others:      Commands the sketch queued before it complete first and
+             are counted off by onReply()
+**********************************************************/
+void BM22S402x_1_PowerManager::submit(uint8_t cmd)
+{
+  _pendingCmd = cmd; // Set first: submitCommand() may complete earlier commands
+  _pendingAhead = _sensor._queueCount;
+  _isPendingDone = false;
+  if (_sensor.submitCommand(cmd))
+  {
+    _wasBusy = true;
+  }
+  else
+  {
+    _pendingCmd = 0;
+  }
+  _checkTime = millis();
+}
+
+/**********************************************************
+Description: Handle the reply to a manager command
+Parameters:  none
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_PowerManager::finishCommand()
+{
+  bool isOK = _pendingStatus == READ_OK;
+  if (_pendingCmd == 0x0d)
+  {
+    if (isOK)
+    {
+      enterState(POWER_ASLEEP);
+    }
+    else
+    {
+      _stateStart = millis(); // Try again after another window
+    }
+  }
+  else if (isOK && (_pendingValue & 0x20) == 0x20)
+  {
+    _isReady = true;
+  }
+  _pendingCmd = 0;
+}
+
+/**********************************************************
+Description: Command completion reported by the module
+Parameters:  status, value: Completed command
+Return:      none
+Others:      Called from the module's update(); keeps the result of
+             the manager's own command, not of commands the sketch
+             queued around it
+**********************************************************/
+void BM22S402x_1_PowerManager::onReply(uint8_t status, uint16_t value)
+{
+  if (_pendingCmd == 0 || _isPendingDone)
+  {
+    return;
+  }
+  if (_pendingAhead > 0)
+  {
+    _pendingAhead--;
+    return;
+  }
+  _isPendingDone = true;
+  _pendingStatus = status;
+  _pendingValue = value;
+}
+
+/**********************************************************
+Description: Start a sampling window or a sleep period
+Parameters:  state: POWER_AWAKE or POWER_ASLEEP
+Return:      none
+Others:      none
+**********************************************************/
+void BM22S402x_1_PowerManager::enterState(uint8_t state)
+{
+  _state = state;
+  _stateStart = millis();
+  _isWakeRequested = false;
+  if (state == POWER_ASLEEP)
+  {
+    _isReady = false;
+  }
+}
@@ -0,0 +1,74 @@
+/*****************************************************************
+File:             BM22S402x-1_Power.h
+Author:           BESTMODULES
+Description:      Duty cycling of a BM22S402x-1 module between
+                  sampling windows and sleep
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_POWER_H_
+#define _BM22S402x_1_POWER_H_
+
+#include "BM22S402x-1.h"
+
+#define BM22S402x_1_POWER_CHECK 100 // Interval of 0x0C reads until the module reports stable(ms)
+
+/* Called while the module sleeps; may put the host to sleep for up to maxMs */
+typedef void (*BM22S402x_1_SleepHook)(uint32_t maxMs);
+
+struct BM22S402x_1_PowerMetrics
+{
+  uint32_t awakeMs;          // Time the module was awake
+  uint32_t sleepMs;          // Time the module was asleep
+  uint32_t uartActiveMs;     // Time a command was in progress
+  uint32_t wakeCount;        // Wake-ups
+  uint32_t triggerWakeCount; // Wake-ups caused by the STATUS pin
+};
+
+class BM22S402x_1_PowerManager
+{
+public:
+  BM22S402x_1_PowerManager(BM22S402x_1 &sensor);
+  void setDutyCycle(uint32_t awakeMs, uint32_t sleepMs);
+  void setWakeOnTrigger(bool isEnable);
+  void setHostSleep(BM22S402x_1_SleepHook hook);
+  void begin();
+  void update();
+  void wake();
+  bool isAwake();
+  bool isReady();
+  const BM22S402x_1_PowerMetrics &getMetrics();
+  void resetMetrics();
+
+private:
+  friend class BM22S402x_1;
+  enum
+  {
+    POWER_AWAKE,
+    POWER_ASLEEP
+  };
+  BM22S402x_1 &_sensor;
+  uint32_t _awakeMs = 1000;
+  uint32_t _sleepMs = 9000;
+  bool _wakeOnTrigger = true;
+  BM22S402x_1_SleepHook _hostSleep = NULL;
+  uint8_t _state = POWER_AWAKE;
+  uint8_t _pendingCmd = 0;   // 0x0C or 0x0D submitted by the manager, 0 if none
+  uint8_t _pendingAhead = 0; // Commands queued before _pendingCmd that have not completed
+  bool _isPendingDone = false;
+  uint8_t _pendingStatus = READ_OK;
+  uint16_t _pendingValue = 0;
+  bool _isReady = false;     // Module reported stable since the last wake-up
+  bool _isWakeRequested = false;
+  uint32_t _stateStart = 0;  // millis() when the window or sleep started
+  uint32_t _checkTime = 0;   // millis() of the last 0x0C read
+  uint32_t _lastUpdate = 0;
+  bool _wasBusy = false;
+  BM22S402x_1_PowerMetrics _metrics;
+  void submit(uint8_t cmd);
+  void finishCommand();
+  void onReply(uint8_t status, uint16_t value);
+  void enterState(uint8_t state);
+};
+
+#endif
@@ -0,0 +1,231 @@
+/*****************************************************************
+File:          BM22S402x-1_Processor.cpp
+Author:        BESTMODULES
+Description:   Fixed-point processing of the AUTO mode PIR stream
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Processor.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Select the packet value to process
+Parameters: source: BM22S402x_1_SOURCE_RAW(default) or BM22S402x_1_SOURCE_FILTERED
+Return: None
+Others: Only used by process(sample)
+**********************************************************/
+void BM22S402x_1_Processor::setSource(uint8_t source)
+{
+  _source = source;
+}
+
+/**********************************************************
+Description: Set the IIR low-pass filter weight
+Parameters: shift: Output moves 1/2^shift toward each sample,
+                   0 bypasses the filter(default 2)
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_Processor::setIIRShift(uint8_t shift)
+{
+  _iirShift = (shift > 15) ? 15 : shift;
+}
+
+/**********************************************************
+Description: Set the moving average length
+Parameters: window: Number of samples averaged, 1 bypasses the
+                    filter(default and maximum: N)
+Return: None
+Others: Clears the samples already averaged
+**********************************************************/
+void BM22S402x_1_Processor::setAverageWindow(uint8_t window)
+{
+  _windowLen = (window == 0) ? 1 : (window > _capacity ? _capacity : window);
+  _windowPos = 0;
+  _windowCount = 0;
+  _windowSum = 0;
+}
+
+/**********************************************************
+Description: Set how fast the baseline follows the signal
+Parameters: shift: Baseline moves 1/2^shift toward each sample(default 6)
+Return: None
+Others: The baseline is frozen while triggered
+**********************************************************/
+void BM22S402x_1_Processor::setBaselineShift(uint8_t shift)
+{
+  _baselineShift = (shift > 15) ? 15 : shift;
+}
+
+/**********************************************************
+Description: Set the trigger detector hysteresis
+Parameters: onLevel: Deviation from the baseline that sets the trigger(default 150)
+            offLevel: Deviation below which the trigger clears(default 80)
+Return: None
+Others: offLevel should be lower than onLevel
+**********************************************************/
+void BM22S402x_1_Processor::setThresholds(uint16_t onLevel, uint16_t offLevel)
+{
+  _onLevel = onLevel;
+  _offLevel = offLevel;
+}
+
+/**********************************************************
+Description: Process one information packet
+Parameters: sample: Decoded information packet
+Return: Trigger detector state after this sample
+Others: None
+**********************************************************/
+bool BM22S402x_1_Processor::process(const BM22S402x_1_Sample &sample)
+{
+  return process((_source == BM22S402x_1_SOURCE_RAW) ? sample.rawPIR : sample.PIR);
+}
+
+/**********************************************************
+Description: Process one PIR value
+Parameters: value: PIR value(AD)
+Return: Trigger detector state after this sample
+Others: Integer only, constant time per sample
+**********************************************************/
+bool BM22S402x_1_Processor::process(uint16_t value)
+{
+  int32_t input = (int32_t)value << 8;
+  uint16_t output = value, baseline;
+  if (!_isPrimed)
+  {
+    _iir = input;
+    _baseline = input;
+    _isPrimed = true;
+  }
+
+  /* IIR low-pass */
+  if (_iirShift > 0)
+  {
+    _iir += (input - _iir) >> _iirShift;
+    output = (uint16_t)((_iir + 128) >> 8);
+  }
+
+  /* Moving average, running sum over the window */
+  if (_windowLen > 1)
+  {
+    if (_windowCount == _windowLen)
+    {
+      _windowSum -= _window[_windowPos];
+    }
+    else
+    {
+      _windowCount++;
+    }
+    _window[_windowPos] = output;
+    _windowSum += output;
+    _windowPos = (_windowPos + 1 == _windowLen) ? 0 : _windowPos + 1;
+    output = _windowSum / _windowCount;
+  }
+  _value = output;
+
+  /* Hysteresis detector against the baseline */
+  baseline = (uint16_t)((_baseline + 128) >> 8);
+  _deviation = (output > baseline) ? output - baseline : baseline - output;
+  if (!_isTriggered && _deviation >= _onLevel)
+  {
+    _isTriggered = true;
+    _triggerCount++;
+  }
+  else if (_isTriggered && _deviation < _offLevel)
+  {
+    _isTriggered = false;
+  }
+  if (!_isTriggered)
+  {
+    _baseline += (((int32_t)output << 8) - _baseline) >> _baselineShift;
+  }
+  return _isTriggered;
+}
+
+/**********************************************************
+Description: Get the filtered value of the last sample
+Parameters: None
+Return: Output of the IIR and moving average stages
+Others: None
+**********************************************************/
+uint16_t BM22S402x_1_Processor::getValue()
+{
+  return _value;
+}
+
+/**********************************************************
+Description: Get the tracked baseline
+Parameters: None
+Return: Baseline value(AD)
+Others: None
+**********************************************************/
+uint16_t BM22S402x_1_Processor::getBaseline()
+{
+  return (uint16_t)((_baseline + 128) >> 8);
+}
+
+/**********************************************************
+Description: Get the distance of the last value from the baseline
+Parameters: None
+Return: |value - baseline|
+Others: None
+**********************************************************/
+uint16_t BM22S402x_1_Processor::getDeviation()
+{
+  return _deviation;
+}
+
+/**********************************************************
+Description: Get the trigger detector state
+Parameters: None
+Return:   1: Triggered
+          0: Not triggered
+Others: None
+**********************************************************/
+bool BM22S402x_1_Processor::isTriggered()
+{
+  return _isTriggered;
+}
+
+/**********************************************************
+Description: Get the number of trigger detections
+Parameters: None
+Return: Rising edges of the detector since reset()
+Others: None
+**********************************************************/
+uint32_t BM22S402x_1_Processor::getTriggerCount()
+{
+  return _triggerCount;
+}
+
+/**********************************************************
+Description: Restart processing
+Parameters: None
+Return: None
+Others: Filters and baseline restart from the next sample,
+        settings are kept
+**********************************************************/
+void BM22S402x_1_Processor::reset()
+{
+  setAverageWindow(_windowLen);
+  _isPrimed = false;
+  _isTriggered = false;
+  _deviation = 0;
+  _value = 0;
+  _triggerCount = 0;
+}
+
+/*-------------------------------------  Protected  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: window: Moving average storage
+            capacity: Number of elements in window
+Return: None
+Others: Called by BM22S402x_1_SignalProcessor<N>
+**********************************************************/
+BM22S402x_1_Processor::BM22S402x_1_Processor(uint16_t *window, uint8_t capacity)
+{
+  _window = window;
+  _capacity = capacity;
+  _windowLen = capacity;
+}
@@ -0,0 +1,77 @@
+/*****************************************************************
+File:             BM22S402x-1_Processor.h
+Author:           BESTMODULES
+Description:      Fixed-point processing of the AUTO mode PIR stream:
+                  IIR and moving average filters, baseline tracking
+                  and a trigger detector with hysteresis
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_PROCESSOR_H_
+#define _BM22S402x_1_PROCESSOR_H_
+
+#include <Arduino.h>
+#include "BM22S402x-1_History.h"
+
+#define BM22S402x_1_SOURCE_RAW 0      // Process the raw PIR value
+#define BM22S402x_1_SOURCE_FILTERED 1 // Process the module's filtered PIR value
+
+/* Processing pipeline; moving average storage is supplied by BM22S402x_1_SignalProcessor<N> */
+class BM22S402x_1_Processor
+{
+public:
+  void setSource(uint8_t source);
+  void setIIRShift(uint8_t shift);
+  void setAverageWindow(uint8_t window);
+  void setBaselineShift(uint8_t shift);
+  void setThresholds(uint16_t onLevel, uint16_t offLevel);
+
+  bool process(const BM22S402x_1_Sample &sample);
+  bool process(uint16_t value);
+
+  uint16_t getValue();
+  uint16_t getBaseline();
+  uint16_t getDeviation();
+  bool isTriggered();
+  uint32_t getTriggerCount();
+  void reset();
+
+protected:
+  BM22S402x_1_Processor(uint16_t *window, uint8_t capacity);
+
+private:
+  uint16_t *_window;
+  uint8_t _capacity;
+  uint8_t _source = BM22S402x_1_SOURCE_RAW;
+  uint8_t _iirShift = 2;      // IIR weight 1/4, 0 bypasses the stage
+  uint8_t _baselineShift = 6; // Baseline weight 1/64
+  uint16_t _onLevel = 150;    // Deviation that sets the trigger
+  uint16_t _offLevel = 80;    // Deviation that clears the trigger
+  uint8_t _windowLen;
+  uint8_t _windowPos = 0;
+  uint8_t _windowCount = 0;
+  uint32_t _windowSum = 0;
+  int32_t _iir = 0;      // IIR output, 8 fractional bits
+  int32_t _baseline = 0; // Baseline, 8 fractional bits
+  uint16_t _value = 0;
+  uint16_t _deviation = 0;
+  bool _isPrimed = false;
+  bool _isTriggered = false;
+  uint32_t _triggerCount = 0;
+};
+
+/* Processor with a moving average of up to N samples(1~255) */
+template <uint8_t N>
+class BM22S402x_1_SignalProcessor : public BM22S402x_1_Processor
+{
+public:
+  BM22S402x_1_SignalProcessor() : BM22S402x_1_Processor(_samples, N)
+  {
+    static_assert(N > 0, "BM22S402x_1_SignalProcessor<N> needs N >= 1");
+  }
+
+private:
+  uint16_t _samples[N];
+};
+
+#endif
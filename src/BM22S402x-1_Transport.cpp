@@ -0,0 +1,134 @@
+/*****************************************************************
+File:          BM22S402x-1_Transport.cpp
+Author:        BESTMODULES
+Description:   Byte link between the driver and the module
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#include "BM22S402x-1_Transport.h"
+
+/*-------------------------------------  Public  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: stream: Opened Stream connected to the module
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_StreamLink::BM22S402x_1_StreamLink(Stream &stream)
+{
+  _stream = &stream;
+}
+
+/**********************************************************
+Description: Start the link
+Parameters: baud: Baud rate, unused
+Return: None
+Others: The stream is opened by the sketch
+**********************************************************/
+void BM22S402x_1_StreamLink::begin(uint32_t baud)
+{
+  (void)baud;
+}
+
+/**********************************************************
+Description: Copy received bytes
+Parameters: buf: Receives the bytes
+            len: Size of buf
+Return: Number of bytes copied, 0 if none was received
+Others: available() is queried once per call, not once per byte
+**********************************************************/
+uint8_t BM22S402x_1_StreamLink::read(uint8_t buf[], uint8_t len)
+{
+  int count = _stream->available();
+  uint8_t i;
+  if (count < len)
+  {
+    len = (count > 0) ? count : 0;
+  }
+  for (i = 0; i < len; i++)
+  {
+    buf[i] = _stream->read();
+  }
+  return len;
+}
+
+/**********************************************************
+Description: Send bytes
+Parameters: buf: Bytes to send
+            len: Number of bytes
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_StreamLink::write(const uint8_t buf[], uint8_t len)
+{
+  _stream->write(buf, len);
+}
+
+/**********************************************************
+Description: Constructor
+Parameters: serial: HardwareSerial port connected to the module
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_HardSerial::BM22S402x_1_HardSerial(HardwareSerial *serial) : BM22S402x_1_StreamLink(serial)
+{
+  _serial = serial;
+}
+
+/**********************************************************
+Description: Start the link
+Parameters: baud: Baud rate
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_HardSerial::begin(uint32_t baud)
+{
+  _serial->begin(baud);
+}
+
+/**********************************************************
+Description: Constructor
+Parameters: rxPin: Receive pin of the UART
+            txPin: Send pin of the UART
+Return: None
+Others: None
+**********************************************************/
+BM22S402x_1_SoftSerial::BM22S402x_1_SoftSerial(uint8_t rxPin, uint8_t txPin)
+    : BM22S402x_1_StreamLink(&_serial), _serial(rxPin, txPin)
+{
+}
+
+/**********************************************************
+Description: Start the link
+Parameters: baud: Baud rate
+Return: None
+Others: None
+**********************************************************/
+void BM22S402x_1_SoftSerial::begin(uint32_t baud)
+{
+  _serial.begin(baud);
+}
+
+/**********************************************************
+Description: Get the underlying SoftwareSerial object
+Parameters: None
+Return: SoftwareSerial object, e.g. for listen() with several ports
+Others: None
+**********************************************************/
+SoftwareSerial &BM22S402x_1_SoftSerial::getSerial()
+{
+  return _serial;
+}
+
+/*-------------------------------------  Protected  -------------------------------------*/
+/**********************************************************
+Description: Constructor
+Parameters: stream: Stream connected to the module, may be NULL
+                    until the link is used
+Return: None
+Others: Used by BM22S402x_1_HardSerial and BM22S402x_1_SoftSerial
+**********************************************************/
+BM22S402x_1_StreamLink::BM22S402x_1_StreamLink(Stream *stream)
+{
+  _stream = stream;
+}
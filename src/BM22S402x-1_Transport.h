@@ -0,0 +1,66 @@
+/*****************************************************************
+File:             BM22S402x-1_Transport.h
+Author:           BESTMODULES
+Description:      Byte link between the driver and the module
+History:
+V1.0.2   -- initial version; 2026-10-17; Arduino IDE :v1.8.19
+******************************************************************/
+#ifndef _BM22S402x_1_TRANSPORT_H_
+#define _BM22S402x_1_TRANSPORT_H_
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+
+#ifndef BM22S402x_1_SOFT_SERIAL_MAX
+#define BM22S402x_1_SOFT_SERIAL_MAX 2 // Modules the (rxPin, txPin) constructor can serve without the heap
+#endif
+
+/* UART backend interface; derive from it to plug in another link */
+class BM22S402x_1_Transport
+{
+public:
+  virtual void begin(uint32_t baud) = 0;
+  virtual uint8_t read(uint8_t buf[], uint8_t len) = 0; // Copy up to len received bytes, never waits
+  virtual void write(const uint8_t buf[], uint8_t len) = 0;
+  virtual bool acquire() { return true; } // Shared links: request the line before a command, false to retry later
+  virtual void release() {}               // Shared links: the reply has been handled
+};
+
+/* Link over any opened Stream, e.g. an RS-485 bridge or USB-CDC port */
+class BM22S402x_1_StreamLink : public BM22S402x_1_Transport
+{
+public:
+  BM22S402x_1_StreamLink(Stream &stream);
+  void begin(uint32_t baud);
+  uint8_t read(uint8_t buf[], uint8_t len);
+  void write(const uint8_t buf[], uint8_t len);
+
+protected:
+  BM22S402x_1_StreamLink(Stream *stream);
+  Stream *_stream;
+};
+
+/* HardwareSerial link, opened by begin() */
+class BM22S402x_1_HardSerial : public BM22S402x_1_StreamLink
+{
+public:
+  BM22S402x_1_HardSerial(HardwareSerial *serial);
+  void begin(uint32_t baud);
+
+private:
+  HardwareSerial *_serial;
+};
+
+/* SoftwareSerial link; declare it globally for static storage */
+class BM22S402x_1_SoftSerial : public BM22S402x_1_StreamLink
+{
+public:
+  BM22S402x_1_SoftSerial(uint8_t rxPin, uint8_t txPin);
+  void begin(uint32_t baud);
+  SoftwareSerial &getSerial();
+
+private:
+  SoftwareSerial _serial;
+};
+
+#endif